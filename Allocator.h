@@ -0,0 +1,168 @@
+#pragma once
+#include "util.h"
+#include "Array.h"
+#include <new>
+
+// node allocators, passed to linked containers as a template parameter
+
+template<typename Type>
+class HeapAllocator
+{
+	// every object is a separate heap allocation
+
+public:
+
+	// constants
+
+	static constexpr bool bulkClear = false;
+
+	// create and destroy
+
+	template<typename... Args>
+	Type* create(Args&&... args)
+	{ return new Type{std::forward<Args>(args)...}; }
+
+	void destroy(Type* data)
+	{ delete data; }
+
+	void clear()
+	{}
+};
+
+template<typename Type>
+class PoolAllocator
+{
+	// objects are carved from blocks of slots by bumping an index, freed slots are kept on a free list.
+	// blocks double in size from a few slots, so pools of short lists stay small. clear() drops every slot
+	// at once and keeps the blocks for reuse, the owner must have destroyed the objects first.
+	// a pool belongs to one container, copies of the container start their own pool.
+
+public:
+
+	// constants
+
+	static constexpr bool bulkClear = true;
+
+private:
+
+	// types
+
+	union Slot
+	{
+		Slot* next;
+		alignas(Type) unsigned char storage[sizeof(Type)];
+	};
+
+	// constants
+
+	static constexpr int firstBlockSize = 4;
+	static constexpr int maxBlockSize = 1024;
+
+	// members
+
+	Array<Slot*> m_Blocks;
+	int m_BlockIndex = -1; // block being carved
+	int m_Used = 0; // slots carved from that block
+	Slot* m_Free = nullptr;
+
+public:
+
+	// constructors and memory management
+
+	PoolAllocator() = default;
+
+	PoolAllocator(const PoolAllocator&)
+	{}
+
+	PoolAllocator& operator=(const PoolAllocator&)
+	{ return *this; }
+
+	PoolAllocator(PoolAllocator&& other) noexcept
+	{ *this = std::move(other); }
+
+	PoolAllocator& operator=(PoolAllocator&& other) noexcept
+	{
+		if(this != &other)
+		{
+			release();
+			m_Blocks = std::move(other.m_Blocks);
+			m_BlockIndex = other.m_BlockIndex;
+			m_Used = other.m_Used;
+			m_Free = other.m_Free;
+
+			other.m_BlockIndex = -1;
+			other.m_Used = 0;
+			other.m_Free = nullptr;
+		}
+
+		return *this;
+	}
+
+	~PoolAllocator()
+	{ release(); }
+
+	// create and destroy
+
+	template<typename... Args>
+	Type* create(Args&&... args)
+	{
+		Slot* slot = m_Free;
+
+		if(slot)
+			m_Free = slot->next;
+		else
+			slot = carve();
+
+		return new(slot->storage) Type{std::forward<Args>(args)...};
+	}
+
+	void destroy(Type* data)
+	{
+		data->~Type();
+		Slot* slot = reinterpret_cast<Slot*>(data);
+		slot->next = m_Free;
+		m_Free = slot;
+	}
+
+	void clear()
+	{
+		m_BlockIndex = -1;
+		m_Used = 0;
+		m_Free = nullptr;
+	}
+
+	void release()
+	{
+		// returns every block to the heap
+
+		for(int index = 0; index < m_Blocks.size(); index++)
+			delete[] m_Blocks[index];
+
+		m_Blocks.clear();
+		clear();
+	}
+
+private:
+
+	// carve implementation
+
+	static int BlockSize(int blockIndex)
+	{
+		int size = firstBlockSize << Min(blockIndex, 8);
+		return (size < maxBlockSize) ? size : maxBlockSize;
+	}
+
+	Slot* carve()
+	{
+		if(m_BlockIndex == -1 || m_Used == BlockSize(m_BlockIndex))
+		{
+			m_BlockIndex++;
+			m_Used = 0;
+
+			if(m_BlockIndex == m_Blocks.size())
+				m_Blocks.InsertBack(new Slot[BlockSize(m_BlockIndex)]);
+		}
+
+		return &m_Blocks[m_BlockIndex][m_Used++];
+	}
+};
@@ -1,10 +1,14 @@
-
 #pragma once
 #include "util.h"
+#include <new>
 
 template<typename Type>
 class Array
 {
+	// elements live in raw storage: only the first size() slots hold constructed elements,
+	// so growing never default-constructs the spare capacity. trivially copyable elements
+	// are copied and moved with memcpy.
+
 private:
 
 	// members
@@ -13,6 +17,10 @@ private:
 	int m_Size = 0;
 	int m_Capacity = 0;
 
+	// traits
+
+	static constexpr bool trivial = std::is_trivially_copyable<Type>::value;
+
 public:
 
 	// constructors
@@ -20,45 +28,53 @@ public:
 	Array() = default;
 
 	explicit Array(int size)
-		: m_Size(size), m_Capacity(size)
-	{
-		if(m_Capacity)
-			m_Data = new Type[m_Capacity]{};
-	}
+	{ resize(size); }
 
 	explicit Array(int size, const Type& data)
-		: Array(size)
-	{ fill(data); }
+	{ resize(size, data); }
 
 	// memory management
 
 	Array(const Array& other)
 	{ *this = other; }
 
+	Array(Array&& other) noexcept
+	{ *this = std::move(other); }
+
 	Array& operator=(const Array& other)
 	{
 		if(this != &other) // self-assignment check
 		{
-			// resize if source is larger than destination
+			clear();
+			reserve(other.m_Size);
+			ConstructCopies(m_Data, other.m_Data, other.m_Size);
+			m_Size = other.m_Size;
+		}
 
-			if(other.m_Size > m_Capacity)
-			{
-				delete[] m_Data;
-				m_Capacity = other.m_Size;
-				m_Data = new Type[m_Capacity]{};
-			}
+		return *this;
+	}
 
-			// copy data and update size
+	Array& operator=(Array&& other) noexcept
+	{
+		// takes over the other array's block
 
-			CopyArray(m_Data, other.m_Data, other.m_Size);
+		if(this != &other)
+		{
+			release();
+			m_Data = other.m_Data;
 			m_Size = other.m_Size;
+			m_Capacity = other.m_Capacity;
+
+			other.m_Data = nullptr;
+			other.m_Size = 0;
+			other.m_Capacity = 0;
 		}
 
 		return *this;
 	}
 
 	~Array()
-	{ delete[] m_Data; }
+	{ release(); }
 
 	// fill
 
@@ -71,7 +87,50 @@ public:
 	{ return m_Size == 0; }
 
 	void clear()
-	{ m_Size = 0; }
+	{
+		// destroys the elements and keeps the capacity
+
+		DestroyRange(0, m_Size);
+		m_Size = 0;
+	}
+
+	// capacity
+
+	void reserve(int capacity)
+	{
+		if(capacity <= m_Capacity)
+			return;
+
+		Type* newData = static_cast<Type*>(::operator new(sizeof(Type) * capacity));
+		ConstructMoves(newData, m_Data, m_Size);
+		DestroyRange(0, m_Size);
+		::operator delete(m_Data);
+
+		m_Data = newData;
+		m_Capacity = capacity;
+	}
+
+	void resize(int size)
+	{
+		// new elements are value-initialized, removed ones are destroyed
+
+		if(ResizeImpl(size))
+			for(int index = m_Size; index < size; index++)
+				new(m_Data + index) Type();
+
+		m_Size = size;
+	}
+
+	void resize(int size, const Type& data)
+	{
+		// new elements are copies of data
+
+		if(ResizeImpl(size))
+			for(int index = m_Size; index < size; index++)
+				new(m_Data + index) Type(data);
+
+		m_Size = size;
+	}
 
 	// access
 
@@ -89,13 +148,13 @@ public:
 
 	Type& operator[](int index)
 	{
-		ErrorAbort(!InRange(index, 0, m_Size - 1), "Array::operator[]() : index out of bounds");
+		CheckAccess(!InRange(index, 0, m_Size - 1), "Array::operator[]() : index out of bounds");
 		return m_Data[index];
 	}
 
 	const Type& operator[](int index) const
 	{
-		ErrorAbort(!InRange(index, 0, m_Size - 1), "Array::operator[]() : index out of bounds");
+		CheckAccess(!InRange(index, 0, m_Size - 1), "Array::operator[]() : index out of bounds");
 		return m_Data[index];
 	}
 
@@ -129,37 +188,62 @@ public:
 	{
 		// after insertion, the data inserted will be positioned at the given index.
 
-		ErrorAbort(!InRange(insertionIndex, 0, m_Size), "Array::insert() : index out of bounds");
-
-		// resize if capacity is reached
-
-		if(m_Size == m_Capacity)
+		if(contains(&insertionData))
 		{
-			Type* oldData = m_Data;
-			m_Capacity = (m_Capacity == 0) ? 2 : (m_Capacity * 2);
-			m_Data = new Type[m_Capacity]{};
-			CopyArray(m_Data, oldData, m_Size);
+			Type copy = insertionData;
+			InsertImpl(std::move(copy), insertionIndex);
 		}
+		else
+			InsertImpl(insertionData, insertionIndex);
+	}
 
-		// update size and insert by shifting right
-
-		m_Size++;
-		ShiftArrayRight(m_Data + insertionIndex, m_Size - insertionIndex);
-		m_Data[insertionIndex] = insertionData;
+	void insert(Type&& insertionData, int insertionIndex)
+	{
+		if(contains(&insertionData))
+		{
+			Type temp = std::move(insertionData);
+			InsertImpl(std::move(temp), insertionIndex);
+		}
+		else
+			InsertImpl(std::move(insertionData), insertionIndex);
 	}
 
 	void InsertFront(const Type& data)
 	{ insert(data, 0); }
 
+	void InsertFront(Type&& data)
+	{ insert(std::move(data), 0); }
+
 	void InsertBack(const Type& data)
 	{ insert(data, m_Size); }
 
+	void InsertBack(Type&& data)
+	{ insert(std::move(data), m_Size); }
+
+	template<typename... Args>
+	Type& EmplaceBack(Args&&... args)
+	{
+		// builds the element in place from its members or constructor arguments
+
+		if(m_Size == m_Capacity)
+		{
+			Type data{std::forward<Args>(args)...}; // arguments may refer to elements, which growing moves
+			grow();
+			new(m_Data + m_Size) Type(std::move(data));
+		}
+		else
+			new(m_Data + m_Size) Type{std::forward<Args>(args)...};
+
+		return m_Data[m_Size++];
+	}
+
 	// remove
 
 	void remove(int removalIndex)
 	{
 		ErrorAbort(!InRange(removalIndex, 0, m_Size - 1), "Array::remove() : index out of bounds");
-		ShiftArrayLeft(m_Data + removalIndex, m_Size - removalIndex);
+		MoveArray(m_Data + removalIndex, m_Data + removalIndex + 1, m_Size - removalIndex - 1);
+		DestroyRange(m_Size - 1, m_Size);
 		m_Size--;
 	}
 
@@ -181,6 +265,93 @@ public:
 
 	void SortDescending()
 	{ SortArrayDescending(m_Data, m_Size); }
+
+private:
+
+	// insert implementation
+
+	bool contains(const Type* data) const
+	{ return m_Data && data >= m_Data && data < m_Data + m_Size; }
+
+	void grow()
+	{ reserve((m_Capacity == 0) ? 2 : (m_Capacity * 2)); }
+
+	template<typename DataType>
+	void InsertImpl(DataType&& insertionData, int insertionIndex)
+	{
+		ErrorAbort(!InRange(insertionIndex, 0, m_Size), "Array::insert() : index out of bounds");
+
+		if(m_Size == m_Capacity)
+			grow();
+
+		if(insertionIndex == m_Size)
+			new(m_Data + m_Size) Type(std::forward<DataType>(insertionData));
+
+		else
+		{
+			// last element moves into the new slot, the rest shift right
+
+			new(m_Data + m_Size) Type(std::move(m_Data[m_Size - 1]));
+			ShiftArrayRight(m_Data + insertionIndex, m_Size - insertionIndex);
+			m_Data[insertionIndex] = std::forward<DataType>(insertionData);
+		}
+
+		m_Size++;
+	}
+
+	// raw storage implementation
+
+	bool ResizeImpl(int size)
+	{
+		// destroys elements past size, or makes room for the new ones and returns true
+
+		ErrorAbort(size < 0, "Array::resize() : negative size");
+
+		if(size < m_Size)
+			DestroyRange(size, m_Size);
+
+		else if(size > m_Size)
+		{
+			reserve(size);
+			return true;
+		}
+
+		return false;
+	}
+
+	static void ConstructCopies(Type* dst, const Type* src, int size)
+	{
+		if(trivial)
+			CopyArray(dst, src, size);
+		else
+			for(int index = 0; index < size; index++)
+				new(dst + index) Type(src[index]);
+	}
+
+	static void ConstructMoves(Type* dst, Type* src, int size)
+	{
+		if(trivial)
+			MoveArray(dst, src, size);
+		else
+			for(int index = 0; index < size; index++)
+				new(dst + index) Type(std::move(src[index]));
+	}
+
+	void DestroyRange(int first, int end)
+	{
+		if(!std::is_trivially_destructible<Type>::value)
+			for(int index = first; index < end; index++)
+				m_Data[index].~Type();
+	}
+
+	void release()
+	{
+		DestroyRange(0, m_Size);
+		::operator delete(m_Data);
+		m_Data = nullptr;
+		m_Size = 0;
+		m_Capacity = 0;
+	}
 };
 
 // compare
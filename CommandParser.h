@@ -50,12 +50,26 @@ public:
 	bool IsSendMsg() const
 	{
 		return
-			m_Tokens.size() == 3 &&
+			(m_Tokens.size() == 3 || (m_Tokens.size() == 4 && m_Tokens[3] == "display")) &&
 			m_Tokens[0] == "send" &&
 			m_Tokens[1] == "msg" &&
 			IsFileName(m_Tokens[2]);
 	}
 
+	bool IsStreamMsg() const
+	{
+		// "-" streams from standard input
+
+		return
+			(m_Tokens.size() == 3 || (m_Tokens.size() == 4 && m_Tokens[3] == "display")) &&
+			m_Tokens[0] == "stream" &&
+			m_Tokens[1] == "msg" &&
+			(IsFileName(m_Tokens[2]) || m_Tokens[2] == "-");
+	}
+
+	bool IsDisplayMode() const
+	{ return m_Tokens.size() == 4 && m_Tokens[3] == "display"; }
+
 	bool IsChangeRT() const
 	{
 		return
@@ -104,12 +118,16 @@ public:
 			String typeA = DeviceType(deviceA);
 			String typeB = DeviceType(deviceB);
 
-			valid = valid &&
+			// numeric addresses may name either type, the network checks them
+
+			valid = valid && (
 				(typeA == "machine" && typeB == "router") ||
 				(typeA == "router" && typeB == "machine") ||
-				(typeA == "router" && typeB == "router");
+				(typeA == "router" && typeB == "router") ||
+				(typeA == "address" && typeB != "none") ||
+				(typeB == "address" && typeA != "none"));
 
-			valid = valid && StrIsNum(m_Tokens[4].data());
+			valid = valid && StrIsReal(m_Tokens[4].data());
 		}
 
 		else return false;
@@ -132,6 +150,33 @@ public:
 	bool IsChangeEdge() const
 	{ return IsChangeEdgeDeviceInput() || IsChangeEdgeFileInput(); }
 
+	bool IsRemoveDevice() const
+	{
+		return
+			m_Tokens.size() == 3 &&
+			m_Tokens[0] == "remove" &&
+			m_Tokens[1] == "device" &&
+			IsDeviceAddress(m_Tokens[2]);
+	}
+
+	bool IsSaveSnapshot() const
+	{
+		return
+			m_Tokens.size() == 3 &&
+			m_Tokens[0] == "save" &&
+			m_Tokens[1] == "snapshot" &&
+			IsSnapshotName(m_Tokens[2]);
+	}
+
+	bool IsExportPath() const
+	{
+		return
+			m_Tokens.size() == 3 &&
+			m_Tokens[0] == "export" &&
+			m_Tokens[1] == "path" &&
+			IsFileName(m_Tokens[2]);
+	}
+
 	// utility methods
 
 	static bool IsExtension(const String& str)
@@ -144,28 +189,38 @@ public:
 	static bool IsFileName(const String& str)
 	{ return str.size() >= 5 && IsExtension(str.substr(str.size() - 4)); }
 
+	static bool IsSnapshotName(const String& str)
+	{ return str.size() >= 6 && str.substr(str.size() - 5) == ".snap"; }
+
 	static bool IsDeviceAddress(const String& str)
 	{ return IsMachineAddress(str) || IsRouterAddress(str); }
 
 	static bool IsMachineAddress(const String& str)
-	{
-		return
-			str.size() == 2 &&
-			ToLower(str[0]) == 'm' &&
-			IsDigit(str[1]);
-	}
+	{ return IsDeviceName(str, 'm') || IsNetAddress(str); }
 
 	static bool IsRouterAddress(const String& str)
+	{ return IsDeviceName(str, 'r') || IsNetAddress(str); }
+
+	static bool IsDeviceName(const String& str, char type)
 	{
+		// type letter followed by a device number, such as m7 or r12
+
 		return
-			str.size() == 2 &&
-			ToLower(str[0]) == 'r' &&
-			IsDigit(str[1]);
+			str.size() >= 2 &&
+			ToLower(str[0]) == type &&
+			IsDigit(str[1]) &&
+			StrIsNum(str.data() + 1);
 	}
 
+	static bool IsNetAddress(const String& str)
+	{ return StrIsNetAddress(str.data()); }
+
 	static String DeviceType(const String& str)
 	{
-		if(IsMachineAddress(str))
+		if(IsNetAddress(str))
+			return "address";
+
+		else if(IsMachineAddress(str))
 			return "machine";
 
 		else if(IsRouterAddress(str))
@@ -0,0 +1,119 @@
+#pragma once
+#include "util.h"
+#include "Array.h"
+
+class CompressedGraph
+{
+	// compressed sparse row (csr) copy of a graph's edges, stored in contiguous arrays.
+	// edges leaving vertex v are the slots [FirstEdge(v), EndEdge(v)), in the order of the graph's edge lists.
+	// edges entering vertex v are the slots [FirstInEdge(v), EndInEdge(v)) of the transposed arrays.
+
+private:
+
+	// members
+
+	Array<int> m_Offsets = Array<int>(1, 0);
+	Array<int> m_Targets;
+	Array<double> m_Weights;
+
+	Array<int> m_InOffsets = Array<int>(1, 0);
+	Array<int> m_Sources;
+	Array<int> m_InSlots; // forward slot of each incoming edge
+
+public:
+
+	// build
+
+	template<typename GraphType>
+	void build(const GraphType& graph)
+	{
+		int vertexCount = graph.VertexCount();
+
+		// count edges leaving and entering each vertex
+
+		m_Offsets = Array<int>(vertexCount + 1, 0);
+		m_InOffsets = Array<int>(vertexCount + 1, 0);
+
+		for(int index = 0; index < vertexCount; index++)
+		{
+			const auto& edges = graph.GetVertex(index).edges;
+			m_Offsets[index + 1] = m_Offsets[index] + edges.size();
+
+			for(auto edge = edges.first(); edge.valid(); ++edge)
+				m_InOffsets[edge->indexB + 1]++;
+		}
+
+		for(int index = 0; index < vertexCount; index++)
+			m_InOffsets[index + 1] += m_InOffsets[index];
+
+		// fill forward slots in edge list order, then scatter them into the transposed slots
+
+		int edgeCount = m_Offsets[vertexCount];
+		m_Targets = Array<int>(edgeCount);
+		m_Weights = Array<double>(edgeCount);
+		m_Sources = Array<int>(edgeCount);
+		m_InSlots = Array<int>(edgeCount);
+		Array<int> inFill(vertexCount, 0);
+
+		for(int index = 0; index < vertexCount; index++)
+		{
+			int slot = m_Offsets[index];
+			const auto& edges = graph.GetVertex(index).edges;
+
+			for(auto edge = edges.first(); edge.valid(); ++edge, slot++)
+			{
+				m_Targets[slot] = edge->indexB;
+				m_Weights[slot] = edge->weight;
+
+				int inSlot = m_InOffsets[edge->indexB] + inFill[edge->indexB]++;
+				m_Sources[inSlot] = index;
+				m_InSlots[inSlot] = slot;
+			}
+		}
+	}
+
+	// empty state
+
+	bool empty() const
+	{ return VertexCount() == 0; }
+
+	void clear()
+	{ *this = CompressedGraph(); }
+
+	// access
+
+	int VertexCount() const
+	{ return m_Offsets.size() - 1; }
+
+	int EdgeCount() const
+	{ return m_Targets.size(); }
+
+	int FirstEdge(int index) const
+	{ return m_Offsets[index]; }
+
+	int EndEdge(int index) const
+	{ return m_Offsets[index + 1]; }
+
+	int GetTarget(int slot) const
+	{ return m_Targets[slot]; }
+
+	double GetWeight(int slot) const
+	{ return m_Weights[slot]; }
+
+	int FirstInEdge(int index) const
+	{ return m_InOffsets[index]; }
+
+	int EndInEdge(int index) const
+	{ return m_InOffsets[index + 1]; }
+
+	int GetSource(int inSlot) const
+	{ return m_Sources[inSlot]; }
+
+	double GetInWeight(int inSlot) const
+	{ return m_Weights[m_InSlots[inSlot]]; }
+
+	// patch
+
+	void SetWeight(int slot, double weight)
+	{ m_Weights[slot] = weight; }
+};
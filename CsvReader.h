@@ -0,0 +1,257 @@
+#pragma once
+#include "util.h"
+#include "Array.h"
+#include "String.h"
+#include <fstream>
+
+struct Token
+{
+	// characters of a line or field inside a reader's buffer, valid until the reader reads its next block
+
+	const char* data = nullptr;
+	int size = 0;
+
+	// access
+
+	bool empty() const
+	{ return size == 0; }
+
+	char front() const
+	{
+		ErrorAbort(empty(), "Token::front() : token is empty");
+		return data[0];
+	}
+
+	String str() const
+	{
+		String result;
+		result.append(data, size);
+		return result;
+	}
+
+	// split
+
+	void split(char delim, Array<Token>& tokens) const
+	{
+		// fills tokens with the fields between delimiters, reusing its capacity
+
+		tokens.clear();
+		const char* begin = data;
+		const char* end = data + size;
+
+		while(true)
+		{
+			const char* found = static_cast<const char*>(std::memchr(begin, delim, end - begin));
+			const char* fieldEnd = found ? found : end;
+			tokens.InsertBack({begin, int(fieldEnd - begin)});
+
+			if(!found)
+				break;
+
+			begin = found + 1;
+		}
+	}
+
+	// numbers
+
+	bool ToReal(double& num) const
+	{
+		// digits, optional fraction such as 12.75. unsigned, since only edge weights are read and those are never negative
+
+		int index = 0;
+		unsigned long long mantissa = 0;
+		int digits = 0;
+		int scale = 0; // digits after the point
+		int dropped = 0; // integer digits past the precision of the mantissa
+		bool point = false;
+
+		for(; index < size; index++)
+		{
+			char ch = data[index];
+
+			if(IsDigit(ch))
+			{
+				if(mantissa < 100000000000000000ull)
+				{
+					mantissa = (mantissa * 10) + (ch - '0');
+					scale += point;
+				}
+				else
+					dropped += !point;
+
+				digits++;
+			}
+
+			else if(ch == '.' && !point)
+				point = true;
+
+			else
+				return false;
+		}
+
+		if(digits == 0)
+			return false;
+
+		// powers of ten up to 1e22 are exact, so short fractions take a single rounding
+
+		double value = double(mantissa);
+		double divisor = 1.0;
+
+		for(; dropped > 0; dropped--)
+			value *= 10.0;
+
+		for(; scale > 0; scale--)
+			divisor *= 10.0;
+
+		value /= divisor;
+
+		num = value;
+		return true;
+	}
+};
+
+class CsvReader
+{
+	// reads a text file in large blocks and hands out its lines without copying them.
+	// lines end at \n and a trailing \r is dropped, so files saved on windows read the same.
+
+public:
+
+	// constants
+
+	static constexpr int defaultBlockSize = 1 << 20;
+
+private:
+
+	// members
+
+	std::ifstream m_File;
+	Array<char> m_Buffer;
+	long long m_BufferOffset = 0; // file offset of the first buffered character
+	int m_Begin = 0; // first unread character
+	int m_End = 0; // end of read characters
+	bool m_Eof = false;
+
+public:
+
+	// constructors
+
+	explicit CsvReader(const String& filepath, int blockSize = defaultBlockSize)
+		: m_File(filepath.data(), std::ios::binary), m_Buffer(Max(blockSize, 1))
+	{}
+
+	CsvReader(const CsvReader&) = delete;
+	CsvReader& operator=(const CsvReader&) = delete;
+
+	// access
+
+	bool IsOpen() const
+	{ return m_File.is_open(); }
+
+	char peek()
+	{
+		// first unread character, '\0' at end of file
+
+		if(m_Begin == m_End && !m_Eof)
+			refill();
+
+		return (m_Begin < m_End) ? m_Buffer[m_Begin] : '\0';
+	}
+
+	long long tell() const
+	{ return m_BufferOffset + m_Begin; }
+
+	// position
+
+	bool seek(long long offset)
+	{
+		// drops the buffer, the next line is read from offset
+
+		m_File.clear();
+		m_File.seekg(offset);
+		m_BufferOffset = offset;
+		m_Begin = 0;
+		m_End = 0;
+		m_Eof = false;
+		return bool(m_File);
+	}
+
+	// read
+
+	bool ReadLine(Token& line)
+	{
+		while(!BufferedLine(line))
+		{
+			if(m_Eof)
+				return false;
+
+			refill();
+		}
+
+		return true;
+	}
+
+	int ReadLines(Array<Token>& lines)
+	{
+		// next line and every complete line after it already in the buffer, 0 at end of file
+
+		lines.clear();
+		Token line;
+
+		if(!ReadLine(line))
+			return 0;
+
+		do
+			lines.InsertBack(line);
+		while(BufferedLine(line));
+
+		return lines.size();
+	}
+
+private:
+
+	// buffer implementation
+
+	bool BufferedLine(Token& line)
+	{
+		// next line if it is complete in the buffer, the unterminated last line counts once the file is read
+
+		const char* begin = m_Buffer.data() + m_Begin;
+		const char* end = m_Buffer.data() + m_End;
+		const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+
+		if(!newline && !(m_Eof && begin < end))
+			return false;
+
+		const char* lineEnd = newline ? newline : end;
+		m_Begin = int((newline ? newline + 1 : end) - m_Buffer.data());
+
+		if(lineEnd > begin && lineEnd[-1] == '\r')
+			lineEnd--;
+
+		line = {begin, int(lineEnd - begin)};
+		return true;
+	}
+
+	void refill()
+	{
+		// keeps the unread part, growing the buffer when a single line fills it
+
+		int unread = m_End - m_Begin;
+		MoveArray(m_Buffer.data(), m_Buffer.data() + m_Begin, unread);
+		m_BufferOffset += m_Begin;
+		m_Begin = 0;
+		m_End = unread;
+
+		if(m_End == m_Buffer.size())
+			m_Buffer.resize(m_Buffer.size() * 2);
+
+		int requested = m_Buffer.size() - m_End;
+		m_File.read(m_Buffer.data() + m_End, requested);
+		int count = int(m_File.gcount());
+		m_End += count;
+
+		if(count < requested)
+			m_Eof = true;
+	}
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include "util.h"
+#include "Message.h"
+
+struct Event
+{
+	// types
+
+	enum class Type {Arrival, Service};
+
+	// members
+
+	double time = 0.0;
+	long long sequence = 0; // breaks ties between events scheduled for the same time
+	Type type = Type::Arrival;
+	int deviceIndex = -1;
+	Message msg; // only used by arrival events
+};
+
+// compare
+
+bool operator<(const Event& e1, const Event& e2)
+{
+	if(e1.time != e2.time)
+		return e1.time < e2.time;
+
+	return e1.sequence < e2.sequence;
+}
+
+bool operator<=(const Event& e1, const Event& e2)
+{ return !(e2 < e1); }
+
+bool operator>(const Event& e1, const Event& e2)
+{ return e2 < e1; }
+
+bool operator>=(const Event& e1, const Event& e2)
+{ return !(e1 < e2); }
@@ -3,6 +3,8 @@
 #include "util.h"
 #include "Array.h"
 #include "List.h"
+#include "HashTable.h"
+#include "CompressedGraph.h"
 
 template<typename Type>
 class Graph
@@ -18,121 +20,310 @@ public:
 		double weight = 0.0;
 	};
 
+	using EdgeList = List<Edge, PoolAllocator>; // each vertex pools its own edge nodes
+
 	struct Vertex
 	{
 		Type data = Type();
-		List<Edge> edges;
+		EdgeList edges;
+		Array<int> sources; // vertices with an edge into this one
+		bool removed = false;
 	};
 
 private:
 
+	// types
+
+	struct EdgeSlot
+	{
+		typename EdgeList::Iterator edge;
+		int compressedSlot = -1; // slot in the compressed copy, valid while it is up to date
+	};
+
 	// members
 
+	// vertex indices are stable: a removed vertex stays behind as a tombstone until compact(),
+	// and its slot is handed to a later InsertVertex() through the free list.
+
 	Array<Vertex> m_Vertices;
+	Array<int> m_FreeIndices; // tombstones
+	HashTable<long long, EdgeSlot> m_EdgeIndex; // every edge by its vertex indices
+	CompressedGraph m_Compressed;
+	bool m_CompressedDirty = true; // vertices or edges changed since last compression
 
 public:
 
 	// empty state
 
 	bool empty() const
-	{ return m_Vertices.empty(); }
+	{ return LiveVertexCount() == 0; }
 
 	void clear()
-	{ m_Vertices.clear(); }
+	{
+		m_Vertices.clear();
+		m_FreeIndices.clear();
+		m_EdgeIndex.clear();
+		m_Compressed.clear();
+		m_CompressedDirty = true;
+	}
+
+	// compressed sparse row copy, rebuilt by compress() after vertices or edges are inserted or removed
+
+	void compress()
+	{
+		if(m_CompressedDirty)
+		{
+			m_Compressed.build(*this);
+			m_CompressedDirty = false;
+
+			// compressed slots follow the edge lists
+
+			int slot = 0;
+
+			for(int index = 0; index < VertexCount(); index++)
+				for(auto edge = m_Vertices[index].edges.first(); edge.valid(); ++edge, slot++)
+					m_EdgeIndex.search(EdgeKey(index, edge->indexB))->compressedSlot = slot;
+		}
+	}
+
+	const CompressedGraph& GetCompressed() const
+	{
+		ErrorAbort(m_CompressedDirty, "Graph::GetCompressed() : graph changed since last compression");
+		return m_Compressed;
+	}
 
 	// access
 
 	int VertexCount() const
-	{ return m_Vertices.size(); }
+	{ return m_Vertices.size(); } // includes tombstones
+
+	int LiveVertexCount() const
+	{ return m_Vertices.size() - m_FreeIndices.size(); }
+
+	bool IsVertex(int index) const
+	{ return InRange(index, 0, VertexCount() - 1) && !m_Vertices[index].removed; }
 
 	Type& GetData(int index)
 	{
-		ErrorAbort(!InRange(index, 0, VertexCount() - 1), "Graph::GetData() : index out of bounds");
+		CheckAccess(!InRange(index, 0, VertexCount() - 1), "Graph::GetData() : index out of bounds");
 		return m_Vertices[index].data;
 	}
 
 	const Type& GetData(int index) const
 	{
-		ErrorAbort(!InRange(index, 0, VertexCount() - 1), "Graph::GetData() : index out of bounds");
+		CheckAccess(!InRange(index, 0, VertexCount() - 1), "Graph::GetData() : index out of bounds");
 		return m_Vertices[index].data;
 	}
 
 	Vertex& GetVertex(int index)
 	{
-		ErrorAbort(!InRange(index, 0, VertexCount() - 1), "Graph::GetVertex() : index out of bounds");
+		CheckAccess(!InRange(index, 0, VertexCount() - 1), "Graph::GetVertex() : index out of bounds");
 		return m_Vertices[index];
 	}
 
 	const Vertex& GetVertex(int index) const
 	{
-		ErrorAbort(!InRange(index, 0, VertexCount() - 1), "Graph::GetVertex() : index out of bounds");
+		CheckAccess(!InRange(index, 0, VertexCount() - 1), "Graph::GetVertex() : index out of bounds");
 		return m_Vertices[index];
 	}
 
-	typename List<Edge>::Iterator GetEdge(int indexA, int indexB)
+	typename EdgeList::Iterator GetEdge(int indexA, int indexB)
 	{
 		ErrorAbort(!(InRange(indexA, 0, VertexCount() - 1) && InRange(indexB, 0, VertexCount() - 1)), "Graph::GetEdge() : index out of bounds");
 
-		auto& vertex = GetVertex(indexA);
-
-		for(auto edge = vertex.edges.first(); edge.valid(); ++edge)
-			if(edge->indexB == indexB)
-				return edge;
-
-		return {};
+		EdgeSlot* edgeSlot = m_EdgeIndex.search(EdgeKey(indexA, indexB));
+		return edgeSlot ? edgeSlot->edge : typename EdgeList::Iterator();
 	}
 
-	typename List<Edge>::ConstIterator GetEdge(int indexA, int indexB) const
+	typename EdgeList::ConstIterator GetEdge(int indexA, int indexB) const
 	{
 		ErrorAbort(!(InRange(indexA, 0, VertexCount() - 1) && InRange(indexB, 0, VertexCount() - 1)), "Graph::GetEdge() : index out of bounds");
 
-		const auto& vertex = GetVertex(indexA);
-
-		for(auto edge = vertex.edges.first(); edge.valid(); ++edge)
-			if(edge->indexB == indexB)
-				return edge;
-
-		return {};
+		const EdgeSlot* edgeSlot = m_EdgeIndex.search(EdgeKey(indexA, indexB));
+		return edgeSlot ? typename EdgeList::ConstIterator(edgeSlot->edge) : typename EdgeList::ConstIterator();
 	}
 
 	// insert
 
-	void InsertVertex(const Type& data)
-	{ m_Vertices.InsertBack({data}); }
+	int InsertVertex(const Type& data)
+	{
+		// returns index of the new vertex, reusing the latest tombstone if there is one
+
+		m_CompressedDirty = true;
+
+		if(m_FreeIndices.empty())
+		{
+			Vertex vertex;
+			vertex.data = data;
+			m_Vertices.InsertBack(std::move(vertex));
+			return VertexCount() - 1;
+		}
+
+		int index = m_FreeIndices.back();
+		m_FreeIndices.RemoveBack();
+		m_Vertices[index].data = data;
+		m_Vertices[index].removed = false;
+		return index;
+	}
 
-	typename List<Edge>::Iterator InsertEdge(int indexA, int indexB, double weight = 0.0)
+	typename EdgeList::Iterator InsertEdge(int indexA, int indexB, double weight = 0.0)
 	{
-		ErrorAbort(!(InRange(indexA, 0, VertexCount() - 1) && InRange(indexB, 0, VertexCount() - 1)), "Graph::InsertEdge() : index out of bounds");
+		ErrorAbort(!(IsVertex(indexA) && IsVertex(indexB)), "Graph::InsertEdge() : index out of bounds or vertex removed");
 		
 		if(GetEdge(indexA, indexB).valid())
 			return {};
 
 		auto& vertex = GetVertex(indexA);
 		vertex.edges.InsertBack({indexA, indexB, weight});
+		GetVertex(indexB).sources.InsertBack(indexA);
+		m_EdgeIndex.insert({EdgeKey(indexA, indexB), {vertex.edges.last()}});
+		m_CompressedDirty = true;
 		return vertex.edges.last();
 	}
 
+	void ReserveEdges(int edgeCount)
+	{ m_EdgeIndex.reserve(edgeCount); }
+
+	// update
+
+	bool SetWeight(int indexA, int indexB, double weight)
+	{
+		// changes the weight in the edge list and patches it into the compressed copy.
+
+		ErrorAbort(!(InRange(indexA, 0, VertexCount() - 1) && InRange(indexB, 0, VertexCount() - 1)), "Graph::SetWeight() : index out of bounds");
+		EdgeSlot* edgeSlot = m_EdgeIndex.search(EdgeKey(indexA, indexB));
+
+		if(!edgeSlot)
+			return false;
+
+		edgeSlot->edge->weight = weight;
+
+		if(!m_CompressedDirty)
+			m_Compressed.SetWeight(edgeSlot->compressedSlot, weight);
+
+		return true;
+	}
+
 	// remove
 
 	void RemoveVertex(int indexA)
 	{
-		ErrorAbort(!InRange(indexA, 0, VertexCount() - 1), "Graph::RemoveVertex() : index out of bounds");
+		// unlinks the vertex's edges and leaves a tombstone. other vertices keep their indices.
+
+		ErrorAbort(!IsVertex(indexA), "Graph::RemoveVertex() : index out of bounds or vertex removed");
+		RemoveEdges(indexA);
+
+		auto& vertex = GetVertex(indexA);
+		vertex.data = Type();
+		vertex.removed = true;
+		m_FreeIndices.InsertBack(indexA);
+		m_CompressedDirty = true;
+	}
+
+	void RemoveEdges(int indexA)
+	{
+		// unlinks every edge into and out of the vertex through the reverse adjacency, in O(degree)
+
+		ErrorAbort(!IsVertex(indexA), "Graph::RemoveEdges() : index out of bounds or vertex removed");
+		auto& vertex = GetVertex(indexA);
 
-		for(int indexB = 0; indexB < VertexCount() - 1; indexB++)
-			RemoveEdge(indexB, indexA);
+		for(int index = 0; index < vertex.sources.size(); index++)
+		{
+			int indexB = vertex.sources[index];
+
+			if(indexB != indexA)
+				GetVertex(indexB).edges.remove(GetEdge(indexB, indexA));
+
+			m_EdgeIndex.remove(EdgeKey(indexB, indexA));
+		}
 
-		m_Vertices.remove(indexA);
+		for(auto edge = vertex.edges.first(); edge.valid(); ++edge)
+		{
+			auto& sources = GetVertex(edge->indexB).sources;
+			sources.remove(sources.search(indexA));
+			m_EdgeIndex.remove(EdgeKey(indexA, edge->indexB));
+		}
+
+		vertex.edges.clear();
+		vertex.sources.clear();
+		m_CompressedDirty = true;
 	}
 
 	bool RemoveEdge(int indexA, int indexB)
 	{
-		if(auto edge = GetEdge(indexA, indexB))
+		auto edge = GetEdge(indexA, indexB);
+
+		if(edge.valid())
 		{
-			auto& vertex = GetVertex(indexA);
-			vertex.edges.remove(edge);
+			auto& sources = GetVertex(indexB).sources;
+			sources.remove(sources.search(indexA));
+			GetVertex(indexA).edges.remove(edge);
+			m_EdgeIndex.remove(EdgeKey(indexA, indexB));
+			m_CompressedDirty = true;
 			return true;
 		}
 
 		return false;
 	}
+
+	// compaction
+
+	Array<int> compact()
+	{
+		// drops the tombstones, moving live vertices down in order, and renumbers the edges.
+		// returns the new index of every old index, -1 for removed ones.
+
+		Array<int> newIndices(VertexCount(), -1);
+		int liveCount = 0;
+
+		for(int index = 0; index < VertexCount(); index++)
+			if(!m_Vertices[index].removed)
+				newIndices[index] = liveCount++;
+
+		if(m_FreeIndices.empty())
+			return newIndices;
+
+		Array<Vertex> vertices;
+		vertices.reserve(liveCount);
+
+		for(int index = 0; index < VertexCount(); index++)
+		{
+			if(m_Vertices[index].removed)
+				continue;
+
+			vertices.InsertBack(std::move(m_Vertices[index]));
+			Vertex& vertex = vertices.back();
+
+			for(auto edge = vertex.edges.first(); edge.valid(); ++edge)
+			{
+				edge->indexA = newIndices[edge->indexA];
+				edge->indexB = newIndices[edge->indexB];
+			}
+
+			for(int source = 0; source < vertex.sources.size(); source++)
+				vertex.sources[source] = newIndices[vertex.sources[source]];
+		}
+
+		m_Vertices = std::move(vertices);
+		m_FreeIndices.clear();
+		m_CompressedDirty = true;
+
+		// edge nodes did not move, only their keys changed
+
+		HashTable<long long, EdgeSlot> edgeIndex(m_EdgeIndex.size());
+
+		for(int index = 0; index < VertexCount(); index++)
+			for(auto edge = m_Vertices[index].edges.first(); edge.valid(); ++edge)
+				edgeIndex.insert({EdgeKey(index, edge->indexB), {edge}});
+
+		m_EdgeIndex = std::move(edgeIndex);
+		return newIndices;
+	}
+
+private:
+
+	// edge index implementation
+
+	static long long EdgeKey(int indexA, int indexB)
+	{ return ((long long)indexA << 32) | unsigned(indexB); }
 };
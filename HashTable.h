@@ -0,0 +1,225 @@
+#pragma once
+#include "util.h"
+#include "Pair.h"
+#include "Array.h"
+#include "String.h"
+
+// hash codes
+
+unsigned HashCode(const String& str)
+{
+	// fnv-1a
+
+	unsigned hash = 2166136261u;
+
+	for(int index = 0; index < str.size(); index++)
+	{
+		hash ^= (unsigned char)str.data()[index];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+unsigned HashCode(long long num)
+{
+	// splitmix64 finalizer
+
+	unsigned long long hash = (unsigned long long)num;
+	hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+	hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+	return unsigned(hash ^ (hash >> 31));
+}
+
+unsigned HashCode(int num)
+{ return HashCode((long long)num); }
+
+template<typename Key, typename Value>
+class HashTable
+{
+	// open addressing with linear probing in a flat power-of-two array of slots.
+	// removal shifts later entries of the probe run back, so no tombstones are left behind.
+
+private:
+
+	// types
+
+	using KeyValue = Pair<Key, Value>;
+
+	struct Slot
+	{
+		KeyValue kv;
+		bool used = false;
+	};
+
+	// members
+
+	Array<Slot> m_Slots;
+	int m_Size = 0;
+
+	// indexing
+
+	int mask() const
+	{ return m_Slots.size() - 1; }
+
+	int home(const Key& key) const
+	{ return int(HashCode(key) & unsigned(mask())); }
+
+public:
+
+	// constructors
+
+	HashTable() = default;
+
+	explicit HashTable(int capacity)
+	{ reserve(capacity); }
+
+	// empty state
+
+	bool empty() const
+	{ return m_Size == 0; }
+
+	void clear()
+	{
+		m_Slots.clear();
+		m_Size = 0;
+	}
+
+	// access
+
+	int size() const
+	{ return m_Size; }
+
+	// search
+
+	Value* search(const Key& key)
+	{
+		int index = find(key);
+		return (index == -1) ? nullptr : &m_Slots[index].kv.second;
+	}
+
+	const Value* search(const Key& key) const
+	{
+		int index = find(key);
+		return (index == -1) ? nullptr : &m_Slots[index].kv.second;
+	}
+
+	// insert
+
+	Value* insert(const KeyValue& kv)
+	{
+		// returns nullptr if key is already present, like SplayTree::insert().
+
+		if((m_Size + 1) * 2 > m_Slots.size())
+			reserve((m_Size + 1) * 2);
+
+		int index = home(kv.first);
+
+		while(m_Slots[index].used)
+		{
+			if(m_Slots[index].kv.first == kv.first)
+				return nullptr;
+
+			index = (index + 1) & mask();
+		}
+
+		m_Slots[index].kv = kv;
+		m_Slots[index].used = true;
+		m_Size++;
+		return &m_Slots[index].kv.second;
+	}
+
+	// remove
+
+	bool remove(const Key& key)
+	{
+		int index = find(key);
+
+		if(index == -1)
+			return false;
+
+		// shift back every later entry of the run that may not sit past its home slot
+
+		int next = (index + 1) & mask();
+
+		while(m_Slots[next].used)
+		{
+			int nextHome = home(m_Slots[next].kv.first);
+			bool movable = (index <= next) ? (nextHome <= index || nextHome > next) : (nextHome <= index && nextHome > next);
+
+			if(movable)
+			{
+				m_Slots[index] = std::move(m_Slots[next]);
+				index = next;
+			}
+
+			next = (next + 1) & mask();
+		}
+
+		m_Slots[index] = Slot();
+		m_Size--;
+		return true;
+	}
+
+	// capacity
+
+	void reserve(int count)
+	{
+		// grows the slot array to the power of two holding count entries at half load, moving entries over.
+
+		int capacity = 8;
+
+		while(capacity < count * 2)
+			capacity *= 2;
+
+		if(capacity <= m_Slots.size())
+			return;
+
+		Array<Slot> oldSlots = std::move(m_Slots);
+		m_Slots = Array<Slot>(capacity);
+
+		for(int index = 0; index < oldSlots.size(); index++)
+			if(oldSlots[index].used)
+				RehashImpl(std::move(oldSlots[index].kv));
+	}
+
+	// print
+
+	void print() const
+	{
+		for(int index = 0; index < m_Slots.size(); index++)
+			if(m_Slots[index].used)
+				std::cout << "\n[" << m_Slots[index].kv.first << ", " << m_Slots[index].kv.second << "]";
+	}
+
+private:
+
+	// find implementation
+
+	int find(const Key& key) const
+	{
+		if(m_Slots.empty())
+			return -1;
+
+		for(int index = home(key); m_Slots[index].used; index = (index + 1) & mask())
+			if(m_Slots[index].kv.first == key)
+				return index;
+
+		return -1;
+	}
+
+	// rehash implementation
+
+	void RehashImpl(KeyValue&& kv)
+	{
+		// keys are already unique, the entry takes the first free slot from its home
+
+		int index = home(kv.first);
+
+		while(m_Slots[index].used)
+			index = (index + 1) & mask();
+
+		m_Slots[index].kv = std::move(kv);
+		m_Slots[index].used = true;
+	}
+};
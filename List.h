@@ -1,8 +1,10 @@
 
 #pragma once
 #include "util.h"
+#include "Allocator.h"
+#include <type_traits>
 
-template<typename Type>
+template<typename Type, template<typename> class Allocator = HeapAllocator>
 class List
 {
 private:
@@ -21,6 +23,7 @@ private:
 	Node* m_First = nullptr;
 	Node* m_Last = nullptr;
 	int m_Size = 0;
+	Allocator<Node> m_Allocator;
 
 public:
 
@@ -171,6 +174,9 @@ public:
 	List(const List& other)
 	{ *this = other; }
 
+	List(List&& other) noexcept
+	{ *this = std::move(other); }
+
 	List& operator=(const List& other)
 	{
 		if(this != &other)
@@ -179,13 +185,13 @@ public:
 
 			if(!other.empty())
 			{
-				m_First = new Node{other.m_First->data};
+				m_First = m_Allocator.create(other.m_First->data);
 				Node* thisNode = m_First;
 				Node* otherNode = other.m_First;
 
 				while(otherNode->next)
 				{
-					thisNode->next = new Node{otherNode->next->data, thisNode};
+					thisNode->next = m_Allocator.create(otherNode->next->data, thisNode);
 					thisNode = thisNode->next;
 					otherNode = otherNode->next;
 				}
@@ -198,6 +204,26 @@ public:
 		return *this;
 	}
 
+	List& operator=(List&& other) noexcept
+	{
+		// takes over the other list's nodes
+
+		if(this != &other)
+		{
+			clear();
+			m_First = other.m_First;
+			m_Last = other.m_Last;
+			m_Size = other.m_Size;
+			m_Allocator = std::move(other.m_Allocator);
+
+			other.m_First = nullptr;
+			other.m_Last = nullptr;
+			other.m_Size = 0;
+		}
+
+		return *this;
+	}
+
 	~List()
 	{ clear(); }
 
@@ -208,15 +234,23 @@ public:
 
 	void clear()
 	{
-		Node* currentNode = m_First;
+		// pooled nodes are released together, and are not even visited if they need no destruction
+
+		bool visitNodes = !(Allocator<Node>::bulkClear && std::is_trivially_destructible<Node>::value);
+		Node* currentNode = visitNodes ? m_First : nullptr;
 
 		while(currentNode)
 		{
 			Node* tempNode = currentNode;
 			currentNode = currentNode->next;
-			delete tempNode;
+
+			if(Allocator<Node>::bulkClear)
+				tempNode->~Node();
+			else
+				m_Allocator.destroy(tempNode);
 		}
 
+		m_Allocator.clear();
 		m_First = nullptr;
 		m_Last = nullptr;
 		m_Size = 0;
@@ -269,44 +303,36 @@ public:
 	{
 		// inserts before given node (pass nullptr to insert at end), returns iterator at inserted node.
 
-		if(empty()) // empty case
-		{
-			ErrorAbort(insertionIterator.valid(), "List::insert() : must insert using null iterator in empty list");
-			m_First = new Node{insertionData};
-			m_Last = m_First;
-			m_Size++;
-			return Iterator(m_First);
-		}
-
-		if(!insertionIterator.valid()) // end case
-		{
-			m_Last->next = new Node{insertionData, m_Last};
-			m_Last = m_Last->next;
-			m_Size++;
-			return Iterator(m_Last);
-		}
-
-		// middle case
+		return LinkNode(m_Allocator.create(insertionData), insertionIterator);
+	}
 
-		Node* insertionNode = insertionIterator.m_Node;
-		Node* newNode = new Node{insertionData, insertionNode->prev, insertionNode};
+	Iterator insert(Type&& insertionData, Iterator insertionIterator)
+	{ return LinkNode(m_Allocator.create(std::move(insertionData)), insertionIterator); }
 
-		if(newNode->prev)
-			newNode->prev->next = newNode;
-		else
-			m_First = newNode; // beginning case
+	template<typename... Args>
+	Iterator emplace(Iterator insertionIterator, Args&&... args)
+	{
+		// builds the element in its node from its members or constructor arguments
 
-		newNode->next->prev = newNode;
-		m_Size++;
-		return Iterator(newNode);
+		return LinkNode(m_Allocator.create(Type{std::forward<Args>(args)...}), insertionIterator);
 	}
 
 	void InsertFront(const Type& data)
 	{ insert(data, Iterator(m_First)); }
 
+	void InsertFront(Type&& data)
+	{ insert(std::move(data), Iterator(m_First)); }
+
 	void InsertBack(const Type& data)
 	{ insert(data, Iterator(nullptr)); }
 
+	void InsertBack(Type&& data)
+	{ insert(std::move(data), Iterator(nullptr)); }
+
+	template<typename... Args>
+	Type& EmplaceBack(Args&&... args)
+	{ return *emplace(Iterator(nullptr), std::forward<Args>(args)...); }
+
 	// remove
 
 	Iterator remove(Iterator removalIterator)
@@ -332,7 +358,7 @@ public:
 			m_Last = m_Last->prev;
 
 		Node* nextNode = removalNode->next;
-		delete removalNode;
+		m_Allocator.destroy(removalNode);
 		m_Size--;
 		return Iterator(nextNode);
 	}
@@ -412,12 +438,52 @@ public:
 			--endIt;
 		}
 	}
+
+private:
+
+	// insert implementation
+
+	Iterator LinkNode(Node* newNode, Iterator insertionIterator)
+	{
+		if(empty()) // empty case
+		{
+			ErrorAbort(insertionIterator.valid(), "List::insert() : must insert using null iterator in empty list");
+			m_First = newNode;
+			m_Last = m_First;
+			m_Size++;
+			return Iterator(m_First);
+		}
+
+		if(!insertionIterator.valid()) // end case
+		{
+			newNode->prev = m_Last;
+			m_Last->next = newNode;
+			m_Last = newNode;
+			m_Size++;
+			return Iterator(m_Last);
+		}
+
+		// middle case
+
+		Node* insertionNode = insertionIterator.m_Node;
+		newNode->prev = insertionNode->prev;
+		newNode->next = insertionNode;
+
+		if(newNode->prev)
+			newNode->prev->next = newNode;
+		else
+			m_First = newNode; // beginning case
+
+		newNode->next->prev = newNode;
+		m_Size++;
+		return Iterator(newNode);
+	}
 };
 
 // compare
 
-template<typename Type>
-bool operator==(const List<Type>& l1, const List<Type>& l2)
+template<typename Type, template<typename> class Allocator>
+bool operator==(const List<Type, Allocator>& l1, const List<Type, Allocator>& l2)
 {
 	if(&l1 == &l2)
 		return true;
@@ -440,6 +506,6 @@ bool operator==(const List<Type>& l1, const List<Type>& l2)
 	return true;
 }
 
-template<typename Type>
-bool operator!=(const List<Type>& l1, const List<Type>& l2)
+template<typename Type, template<typename> class Allocator>
+bool operator!=(const List<Type, Allocator>& l1, const List<Type, Allocator>& l2)
 { return !(l1 == l2); }
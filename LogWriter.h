@@ -0,0 +1,225 @@
+#pragma once
+#include "util.h"
+#include "String.h"
+#include "SpscQueue.h"
+#include <cstdio>
+#include <condition_variable>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+class LogWriter
+{
+	// appends records to a file from a background thread. the producing thread only pushes records into a lock-free
+	// queue, the writer thread gathers them into a large buffer and writes it with a single call.
+
+public:
+
+	// types
+
+	enum class FlushPolicy
+	{
+		OnFull, // the buffer is written when full, on flush() and on close()
+		OnIdle, // also written whenever the queue runs empty
+		Sync // as OnIdle, and every write is synced to disk
+	};
+
+	// constants
+
+	static constexpr int queueCapacity = 1 << 16;
+	static constexpr int bufferSize = 1 << 20;
+
+private:
+
+	// members
+
+	SpscQueue<String> m_Queue{queueCapacity};
+	std::thread m_Thread;
+	std::FILE* m_File = nullptr;
+	String m_Path;
+	FlushPolicy m_Policy = FlushPolicy::OnIdle;
+
+	long long m_Pushed = 0; // producer only
+	long long m_Size = 0; // file size once every pushed record is written, producer only
+	std::atomic<long long> m_Written{0}; // records in the file
+	std::atomic<long long> m_FlushTarget{0}; // records the producer waits for
+	std::atomic<bool> m_Stop{false};
+	std::atomic<bool> m_Waiting{false}; // the writer sleeps on the condition
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition; // wakes the writer, and the producer waiting in flush()
+
+public:
+
+	// constructors and memory management
+
+	LogWriter() = default;
+
+	LogWriter(const LogWriter&) = delete;
+	LogWriter& operator=(const LogWriter&) = delete;
+
+	~LogWriter()
+	{ close(); }
+
+	// open and close
+
+	bool open(const String& filepath, FlushPolicy policy = FlushPolicy::OnIdle)
+	{
+		close();
+		m_Size = std::ifstream(filepath.data(), std::ios::binary | std::ios::ate).tellg();
+		m_File = std::fopen(filepath.data(), "ab");
+
+		if(!m_File)
+			return false;
+
+		m_Path = filepath;
+		m_Policy = policy;
+		m_Size = Max(m_Size, 0ll);
+		m_Pushed = 0;
+		m_Written = 0;
+		m_FlushTarget = 0;
+		m_Stop = false;
+		m_Thread = std::thread(&LogWriter::WriterLoop, this);
+		return true;
+	}
+
+	void close()
+	{
+		// writes every pushed record, then stops the writer
+
+		if(!IsOpen())
+			return;
+
+		{
+			std::lock_guard<std::mutex> guard(m_Mutex);
+			m_Stop = true;
+		}
+
+		m_Condition.notify_all();
+		m_Thread.join();
+		std::fclose(m_File);
+		m_File = nullptr;
+		m_Path.clear();
+	}
+
+	// access
+
+	bool IsOpen() const
+	{ return m_File != nullptr; }
+
+	const String& GetPath() const
+	{ return m_Path; }
+
+	long long size() const
+	{ return m_Size; }
+
+	// write
+
+	long long push(String&& record)
+	{
+		// returns the file offset the record is written at, waits for room while the writer is behind
+
+		long long offset = m_Size;
+		m_Size += record.size();
+
+		while(!m_Queue.push(std::move(record)))
+			std::this_thread::yield();
+
+		// the writer only sleeps on an empty queue, so it is woken only when it may have missed this record.
+		// the fence pairs with the writer's, one of the two sees the other's store.
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if(m_Waiting)
+		{
+			std::lock_guard<std::mutex> guard(m_Mutex);
+			m_Condition.notify_all();
+		}
+
+		m_Pushed++;
+		return offset;
+	}
+
+	void flush()
+	{
+		// blocks until every pushed record is in the file
+
+		if(!IsOpen())
+			return;
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_FlushTarget = m_Pushed;
+		m_Condition.notify_all();
+		m_Condition.wait(lock, [this]() { return m_Written >= m_Pushed; });
+	}
+
+private:
+
+	// writer implementation
+
+	void WriterLoop()
+	{
+		String buffer;
+		buffer.reserve(bufferSize);
+		long long bufferedRecords = 0;
+		String record;
+
+		while(true)
+		{
+			while(buffer.size() < bufferSize && m_Queue.pop(record))
+			{
+				buffer += record;
+				bufferedRecords++;
+			}
+
+			bool idle = m_Queue.empty();
+			bool stop = m_Stop && idle;
+			bool flushWanted = m_Written + bufferedRecords <= m_FlushTarget || m_Policy != FlushPolicy::OnFull;
+
+			if(!buffer.empty() && (buffer.size() >= bufferSize || stop || (idle && flushWanted)))
+			{
+				WriteBuffer(buffer);
+				buffer.clear();
+
+				std::lock_guard<std::mutex> guard(m_Mutex);
+				m_Written += bufferedRecords;
+				bufferedRecords = 0;
+				m_Condition.notify_all();
+			}
+
+			if(stop)
+				return;
+
+			if(idle)
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Waiting = true;
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				m_Condition.wait(lock, [this]() { return m_Stop || m_FlushTarget > m_Written || !m_Queue.empty(); });
+				m_Waiting = false;
+			}
+		}
+	}
+
+	void WriteBuffer(const String& buffer)
+	{
+		std::fwrite(buffer.data(), 1, buffer.size(), m_File);
+		std::fflush(m_File);
+
+		if(m_Policy == FlushPolicy::Sync)
+		{
+			#if defined(_WIN32)
+
+			_commit(_fileno(m_File));
+
+			#else
+
+			fsync(fileno(m_File));
+
+			#endif
+		}
+	}
+};
@@ -14,6 +14,7 @@ private:
 
 	Queue<Message> m_InQueue;
 	String m_RouterAddress;
+	int m_RouterID = -1;
 
 public:
 
@@ -31,22 +32,30 @@ public:
 	const String& GetRouterAddress() const
 	{ return m_RouterAddress; }
 
+	int GetRouterID() const
+	{ return m_RouterID; }
+
 	// setters
 
 	void SetRouterAddress(const String& routerAddress)
 	{ m_RouterAddress = routerAddress; }
 
+	void SetRouterID(int routerID)
+	{ m_RouterID = routerID; }
+
 	// messages
 
 	void InsertMessage(const Message& msg) override
 	{ m_InQueue.enqueue(msg); }
 
+	void InsertMessage(Message&& msg) override
+	{ m_InQueue.enqueue(std::move(msg)); }
+
 	bool ReadMessage() override
 	{
 		if(!m_InQueue.empty())
 		{
-			m_OutQueue.enqueue(m_InQueue.front());
-			m_InQueue.dequeue();
+			m_OutQueue.enqueue(m_InQueue.extract());
 			return true;
 		}
 		else return false;
@@ -0,0 +1,169 @@
+#pragma once
+#include "util.h"
+
+#if defined(_WIN32)
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <windows.h>
+
+#else
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#endif
+
+class MappedFile
+{
+	// read-only view of a whole file mapped into memory, unmapped on destruction
+
+private:
+
+	// members
+
+	const char* m_Data = nullptr;
+	long long m_Size = 0;
+
+public:
+
+	// constructors and memory management
+
+	MappedFile() = default;
+
+	explicit MappedFile(const char* filepath)
+	{ open(filepath); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile()
+	{ close(); }
+
+	// open and close
+
+	bool open(const char* filepath)
+	{
+		close();
+
+		#if defined(_WIN32)
+
+		HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if(file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		HANDLE mapping = nullptr;
+
+		if(GetFileSizeEx(file, &size) && size.QuadPart > 0)
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		CloseHandle(file); // the mapping keeps the file open
+
+		if(!mapping)
+			return false;
+
+		const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping); // the view keeps the mapping alive
+
+		if(!view)
+			return false;
+
+		m_Data = static_cast<const char*>(view);
+		m_Size = size.QuadPart;
+
+		#else
+
+		int file = ::open(filepath, O_RDONLY);
+
+		if(file == -1)
+			return false;
+
+		struct stat status;
+		void* view = MAP_FAILED;
+
+		if(fstat(file, &status) == 0 && status.st_size > 0)
+			view = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+		::close(file); // the mapping keeps the file open
+
+		if(view == MAP_FAILED)
+			return false;
+
+		m_Data = static_cast<const char*>(view);
+		m_Size = status.st_size;
+
+		#endif
+
+		return true;
+	}
+
+	void close()
+	{
+		if(!m_Data)
+			return;
+
+		#if defined(_WIN32)
+
+		UnmapViewOfFile(m_Data);
+
+		#else
+
+		munmap(const_cast<char*>(m_Data), size_t(m_Size));
+
+		#endif
+
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	// access
+
+	bool IsOpen() const
+	{ return m_Data != nullptr; }
+
+	const char* data() const
+	{ return m_Data; }
+
+	long long size() const
+	{ return m_Size; }
+};
+
+bool GetFileStamp(const char* filepath, long long& size, long long& time)
+{
+	// size and last modification time of a file, false if it cannot be read.
+	// the time is only compared for equality, its unit differs between platforms.
+
+	#if defined(_WIN32)
+
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+	if(!GetFileAttributesExA(filepath, GetFileExInfoStandard, &attributes))
+		return false;
+
+	size = ((long long)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	time = ((long long)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+
+	#else
+
+	struct stat status;
+
+	if(stat(filepath, &status) != 0)
+		return false;
+
+	size = status.st_size;
+	time = status.st_mtime;
+
+	#endif
+
+	return true;
+}
@@ -2,6 +2,8 @@
 #pragma once
 #include "util.h"
 #include "String.h"
+#include "SharedString.h"
+#include "Trace.h"
 
 struct Message
 {
@@ -9,8 +11,10 @@ struct Message
 	int priority = 0;
 	String srcAddress;
 	String dstAddress;
-	String payload;
-	String trace;
+	SharedString payload; // stored once, hops only copy the handle
+	Trace trace; // device ids, rendered to text only when the path is written
+	int srcID = -1; // device ids resolved once when the message enters the network
+	int dstID = -1;
 };
 
 bool operator<(const Message& m1, const Message& m2)
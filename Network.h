@@ -9,13 +9,24 @@
 #include "Queue.h"
 #include "PriorityQueue.h"
 #include "SplayTree.h"
+#include "HashTable.h"
+#include "PrefixTrie.h"
 #include "Graph.h"
+#include "ThreadPool.h"
+#include "MappedFile.h"
+#include "CsvReader.h"
+#include "LogWriter.h"
+#include "SpscQueue.h"
+#include "PathLog.h"
+#include "PathIndex.h"
 #include "Message.h"
+#include "Event.h"
 #include "NetworkDevice.h"
 #include "Machine.h"
 #include "Router.h"
 
 #define PRINT_SHORTEST_PATH_TABLE 0
+#define DYNAMIC_SHORTEST_PATHS 1
 
 class Network
 {
@@ -27,15 +38,127 @@ public:
 	using Machine = Machine;
 	using Router = Router;
 	using Graph = Graph<Device*>;
-	using Map = SplayTree<String, int>;
+	using Map = SplayTree<String, int, PoolAllocator>;
+	using NetMap = HashTable<long long, int>; // device index by numeric address
+	using MessageSource = std::function<bool(Message&)>; // fills in the next message, false once the source is exhausted
+
+	// addressing
+
+	static constexpr unsigned networkPrefix = 10u << 24; // 10.0.0.0/8
+	static constexpr int routerPrefixLength = 24;
+	static constexpr int hostPrefixLength = 32;
 
 private:
 
+	// types
+
+	struct ShortestPathTree
+	{
+		Array<double> distances;
+		Array<int> parents;
+		Array<int> nextHops; // first device after the router on the path to each device
+	};
+
+	struct EdgeChange
+	{
+		int indexA = -1;
+		int indexB = -1;
+		double oldWeight = 0.0;
+		double newWeight = 0.0;
+	};
+
+	// snapshot file: header, then sections in the order below, each starting on an 8-byte boundary.
+	// values are stored in native byte order so that a mapped file is read in place.
+
+	struct SnapshotHeader
+	{
+		char magic[8];
+		int version = 0;
+		int deviceCount = 0;
+		int edgeCount = 0;
+		int routerCount = 0;
+		long long nameBytes = 0;
+		long long sourceSize = -1; // topology file the network was created from, see IsSnapshotCurrent()
+		long long sourceTime = 0;
+	};
+
+	struct SnapshotLayout
+	{
+		// byte offsets of the sections
+
+		long long nameOffsets = 0; // int[deviceCount + 1]
+		long long names = 0; // char[nameBytes]
+		long long edgeOffsets = 0; // int[deviceCount + 1], compressed adjacency
+		long long targets = 0; // int[edgeCount]
+		long long weights = 0; // double[edgeCount]
+		long long routers = 0; // int[routerCount]
+		long long trees = 0; // routerCount blocks of double distances, int parents, int next hops, each [deviceCount]
+		long long treeBytes = 0;
+		long long size = 0;
+
+		explicit SnapshotLayout(const SnapshotHeader& header)
+		{
+			long long devices = header.deviceCount;
+			long long edges = header.edgeCount;
+
+			nameOffsets = AlignSection(sizeof(SnapshotHeader));
+			names = nameOffsets + AlignSection(sizeof(int) * (devices + 1));
+			edgeOffsets = names + AlignSection(header.nameBytes);
+			targets = edgeOffsets + AlignSection(sizeof(int) * (devices + 1));
+			weights = targets + AlignSection(sizeof(int) * edges);
+			routers = weights + AlignSection(sizeof(double) * edges);
+			trees = routers + AlignSection(sizeof(int) * header.routerCount);
+			treeBytes = AlignSection(sizeof(double) * devices) + (2 * AlignSection(sizeof(int) * devices));
+			size = trees + (treeBytes * header.routerCount);
+		}
+
+		static long long AlignSection(long long bytes)
+		{ return (bytes + 7) & ~7ll; }
+	};
+
+	static constexpr int snapshotVersion = 2;
+
+	static const char* SnapshotMagic()
+	{ return "NSIMSNAP"; }
+
+	// delivered paths are appended by a background writer, written whenever the simulation outpaces it.
+	// a log named *.bin is written in the binary format of PathLog.
+
+	static constexpr LogWriter::FlushPolicy pathLogPolicy = LogWriter::FlushPolicy::OnIdle;
+
+	// messages read from standard input wait here until the simulation thread injects them
+
+	static constexpr int inputQueueCapacity = 1 << 10;
+
 	// members
 
 	Graph m_Graph;
 	Map m_Map;
+	NetMap m_NetMap;
 	Router::TableType m_RoutingTableType = Router::TableType();
+	long long m_SourceSize = -1; // size and modification time of the topology file, carried through snapshots
+	long long m_SourceTime = 0;
+
+	// discrete-event simulation state
+
+	PriorityQueue<LesserEqual<Event>> m_Events;
+	Array<bool> m_Busy; // device has a pending service event
+	double m_Time = 0.0;
+	long long m_EventSequence = 0;
+	long long m_EventCount = 0;
+	long long m_InFlight = 0; // messages injected and not yet delivered or dropped
+	LogWriter m_PathLog;
+	PathLogEncoder m_PathEncoder; // only open for a binary log
+	PathIndex m_PathIndex; // records of m_PathLog by source and destination
+
+	// shortest paths of all routers are found in parallel
+
+	ThreadPool m_ThreadPool;
+
+	// shortest path trees are kept to repair routing tables after edge changes
+
+	Array<ShortestPathTree> m_Trees; // indexed by device, only filled for routers
+	Array<int> m_RouterIndices;
 
 	// constructors
 
@@ -54,10 +177,55 @@ public:
 
 	static void Init(const String& filepath, Router::TableType routingTableType)
 	{
-		Create(filepath, routingTableType);
-		FindShortestPaths();
+		// snapshots already hold the shortest paths
+
+		if(IsSnapshot(filepath))
+			LoadSnapshot(filepath, routingTableType);
+
+		else
+		{
+			Create(filepath, routingTableType);
+			FindShortestPaths();
+		}
+	}
+
+	// snapshots
+
+	static bool IsSnapshot(const String& filepath)
+	{
+		char magic[8]{};
+		std::ifstream fin(filepath.data(), std::ios::binary);
+		fin.read(magic, sizeof(magic));
+		return fin && std::memcmp(magic, SnapshotMagic(), sizeof(magic)) == 0;
+	}
+
+	static bool IsSnapshotCurrent(const String& filepath, const String& sourcePath)
+	{
+		// a snapshot is current while the topology file it was created from keeps its size and modification time.
+		// without a readable topology file there is nothing newer to load.
+
+		SnapshotHeader header;
+		std::ifstream fin(filepath.data(), std::ios::binary);
+		fin.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+		if(!fin || std::memcmp(header.magic, SnapshotMagic(), sizeof(header.magic)) != 0 || header.version != snapshotVersion)
+			return false;
+
+		long long size = 0;
+		long long time = 0;
+
+		if(!GetFileStamp(sourcePath.data(), size, time))
+			return true;
+
+		return size == header.sourceSize && time == header.sourceTime;
 	}
 
+	static bool SaveSnapshot(const String& filepath)
+	{ return Instance().SaveSnapshotImpl(filepath); }
+
+	static void LoadSnapshot(const String& filepath, Router::TableType routingTableType)
+	{ Instance().LoadSnapshotImpl(filepath, routingTableType); }
+
 	// create and delete
 
 	static void Create(const String& filepath, Router::TableType routingTableType)
@@ -69,10 +237,15 @@ public:
 	// getters
 
 	static int DeviceCount()
-	{ return Instance().m_Graph.VertexCount(); }
+	{ return Instance().m_Graph.VertexCount(); } // includes removed devices, whose ids stay taken until compaction
+
+	static bool IsDevice(int deviceIndex)
+	{ return Instance().m_Graph.IsVertex(deviceIndex); }
 
 	static Device* GetDevice(int deviceIndex)
 	{
+		// nullptr for a removed device, so GetMachine() and GetRouter() return nullptr for it too
+
 		ErrorAbort(!InRange(deviceIndex, 0, DeviceCount() - 1), "Network::GetDevice() : index out of bounds");
 		return Instance().m_Graph.GetData(deviceIndex);
 	}
@@ -91,8 +264,8 @@ public:
 
 	static Device* GetDevice(const String& deviceAddress)
 	{
-		auto search = Instance().m_Map.search(deviceAddress);
-		return search ? GetDevice(*search) : nullptr;
+		int deviceIndex = Instance().GetDeviceIndex(deviceAddress);
+		return (deviceIndex != -1) ? GetDevice(deviceIndex) : nullptr;
 	}
 
 	static Machine* GetMachine(const String& machineAddress)
@@ -101,7 +274,7 @@ public:
 	static Router* GetRouter(const String& routerAddress)
 	{ return DeviceToRouter(GetDevice(routerAddress)); }
 
-	static List<Graph::Edge>::ConstIterator GetEdge(int indexA, int indexB)
+	static Graph::EdgeList::ConstIterator GetEdge(int indexA, int indexB)
 	{
 		ErrorAbort(!(InRange(indexA, 0, DeviceCount() - 1) && InRange(indexB, 0, DeviceCount() - 1)), "Network::GetEdge() : index out of bounds");
 		return Instance().m_Graph.GetEdge(indexA, indexB);
@@ -122,12 +295,24 @@ public:
 	static void PrintMachineRouters()
 	{ Instance().PrintMachineRoutersImpl(); }
 
+	static void PrintNetAddresses()
+	{ Instance().PrintNetAddressesImpl(); }
+
 	static void PrintRoutingLists()
 	{ Instance().PrintRoutingListsImpl(); }
 
 	static void PrintRoutingTrees()
 	{ Instance().PrintRoutingTreesImpl(); }
 
+	static void PrintRoutingHashes()
+	{ Instance().PrintRoutingHashesImpl(); }
+
+	static void PrintRoutingDirects()
+	{ Instance().PrintRoutingDirectsImpl(); }
+
+	static void PrintRoutingTries()
+	{ Instance().PrintRoutingTriesImpl(); }
+
 	static void PrintRoutingTables()
 	{
 		if(Instance().m_RoutingTableType == Router::TableType::List)
@@ -135,6 +320,15 @@ public:
 
 		else if(Instance().m_RoutingTableType == Router::TableType::Tree)
 			PrintRoutingTrees();
+
+		else if(Instance().m_RoutingTableType == Router::TableType::Hash)
+			PrintRoutingHashes();
+
+		else if(Instance().m_RoutingTableType == Router::TableType::Direct)
+			PrintRoutingDirects();
+
+		else if(Instance().m_RoutingTableType == Router::TableType::Trie)
+			PrintRoutingTries();
 	}
 
 	// shortest paths
@@ -144,35 +338,50 @@ public:
 
 	// commandline
 
-	static void SendMsg(const List<Message>& msgList, const String& filepath)
+	static void SendMsg(List<Message> msgList, const String& filepath, bool display = false)
 	{ 
 		simulation::run_flag = true;
-		simulation::thread = new std::thread(&Network::SendMsgImpl, &Instance(), msgList, filepath);
+		simulation::display_flag = display;
+		simulation::thread = new std::thread(&Network::SendMsgImpl, &Instance(), std::move(msgList), filepath);
+	}
+
+	static void StreamMsg(const MessageSource& source, const String& filepath, bool display = false, bool background = true)
+	{
+		// messages are pulled from the source while the simulation runs, a source reading standard input
+		// runs in the foreground so that it does not compete with the query prompt
+
+		simulation::run_flag = true;
+		simulation::display_flag = display;
+
+		if(background)
+			simulation::thread = new std::thread(&Network::StreamMsgImpl, &Instance(), source, filepath, nullptr);
+		else
+			Instance().StreamInputMsgImpl(source, filepath);
 	}
 
 	static bool ChangeRT(const String& routerAddress, const String& action, const Router::List& fieldList)
 	{ return Instance().ChangeRT_Impl(routerAddress, action, fieldList); }
 
+	static void OpenPathLog(const String& filepath)
+	{ Instance().OpenPathLogImpl(filepath); }
+
 	static void PrintPath(const String& srcAddress, const String& dstAddress, const String& filepath)
-	{ Instance().PrintPathImpl(srcAddress, dstAddress, filepath); }
+	{ Instance().PrintPathImpl(Instance().GetDeviceName(srcAddress), Instance().GetDeviceName(dstAddress), filepath); }
 
-	static bool ChangeEdge(const String& srcAddress, const String& dstAddress, double edgeWeight)
-	{ 
-		if(!Instance().ChangeEdgeImpl(srcAddress, dstAddress, edgeWeight))
-			return false;
+	static long long ExportPath(const String& logpath, const String& filepath)
+	{ return Instance().ExportPathImpl(logpath, filepath); }
 
-		FindShortestPaths();
-		return true;
-	}
+	static bool ChangeEdge(const String& srcAddress, const String& dstAddress, double edgeWeight)
+	{ return Instance().ChangeEdgeImpl(srcAddress, dstAddress, edgeWeight); }
 
 	static bool ChangeEdge(const List<Graph::Edge>& edgeList)
-	{
-		if(!Instance().ChangeEdgeImpl(edgeList))
-			return false;
+	{ return Instance().ChangeEdgeImpl(edgeList); }
 
-		FindShortestPaths();
-		return true;
-	}
+	static bool RemoveDevice(const String& deviceAddress)
+	{ return Instance().RemoveDeviceImpl(deviceAddress); }
+
+	static void CompactDevices()
+	{ Instance().CompactDevicesImpl(); }
 
 private:
 
@@ -202,67 +411,148 @@ private:
 
 	void CreateImpl(const String& filepath, Router::TableType routingTableType)
 	{
-		std::ifstream fin(filepath.data());
-		ErrorAbort(!fin, "Network::CreateImpl() : failed to open file");
+		// a dense adjacency matrix starts with the empty corner cell of its header row,
+		// anything else is read as a sparse edge list
+
+		CsvReader reader(filepath);
+		ErrorAbort(!reader.IsOpen(), "Network::CreateImpl() : failed to open file");
+
+		if(!GetFileStamp(filepath.data(), m_SourceSize, m_SourceTime))
+			m_SourceSize = -1;
+
+		if(reader.peek() == ',')
+			CreateDenseImpl(reader);
+		else
+			CreateSparseImpl(reader);
+
+		// devices are declared in file order, which leaves the splay tree as a chain for the const lookups
+
+		m_Map.balance();
+		m_RoutingTableType = routingTableType;
+		m_Busy = Array<bool>(m_Graph.VertexCount(), false);
+		m_Graph.compress();
+	}
+
+	void CreateDenseImpl(CsvReader& reader)
+	{
+		// header row of device names, then one row of edge weights (or ?) per device.
+		// the rows of each block read are parsed in parallel, then their edges are inserted in row order.
 
-		char ch = '\0';
-		String token;
-		int rowIndex = -1;
-		int colIndex = -1;
+		Token line;
+		Array<Token> names;
 
-		while(true)
+		if(reader.ReadLine(line))
 		{
-			ch = fin.get();
+			line.split(',', names);
 
-			if(!fin || ch == '\n' || ch == ',')
-			{
-				if(rowIndex == -1 && token.size() > 1)
-				{
-					Device* device = nullptr;
+			for(int colIndex = 1; colIndex < names.size(); colIndex++)
+				if(names[colIndex].size > 1)
+					InsertDevice(names[colIndex].str());
+		}
 
-					if(ToUpper(token.front()) == 'M')
-						device = new Machine(token);
+		Array<Token> lines;
+		Array<int> rowIndices;
+		Array<Array<Graph::Edge>> rowEdges;
+		int rowCount = 0;
 
-					else if(ToUpper(token.front()) == 'R')
-						device = new Router(token);
+		while(reader.ReadLines(lines))
+		{
+			// blank lines are not rows
 
-					else
-						ErrorAbort(true, "Network::CreateImpl() : invalid network device type");
+			rowIndices.resize(lines.size());
+			rowEdges.resize(lines.size());
 
-					m_Graph.InsertVertex(device);
+			for(int job = 0; job < lines.size(); job++)
+				rowIndices[job] = lines[job].empty() ? -1 : rowCount++;
 
-					if(!m_Map.insert({token, m_Graph.VertexCount() - 1}))
-					{
-						delete device;
-						ErrorAbort(true, "Network::CreateImpl() : duplicate device inserted");
-					}
-				}
+			m_ThreadPool.ParallelFor(lines.size(), [&](int job)
+			{
+				Array<Graph::Edge>& edges = rowEdges[job];
+				edges.clear();
+
+				if(rowIndices[job] == -1)
+					return;
 
-				else if(colIndex != -1 && !token.empty() && token.front() != '?')
+				Array<Token> cells;
+				lines[job].split(',', cells);
+
+				for(int colIndex = 1; colIndex < cells.size(); colIndex++)
 				{
-					ErrorAbort(!StrIsNum(token.data()), "Network::CreateImpl() : invalid edge weight");
-					m_Graph.InsertEdge(rowIndex, colIndex, double(int(token.front())) - '0');
+					const Token& cell = cells[colIndex];
+					double weight = 0.0;
+
+					if(cell.empty() || cell.front() == '?')
+						continue;
+
+					ErrorAbort(!cell.ToReal(weight), "Network::CreateImpl() : invalid edge weight");
+					edges.InsertBack({rowIndices[job], colIndex - 1, weight});
 				}
+			});
+
+			for(int job = 0; job < lines.size(); job++)
+				for(int index = 0; index < rowEdges[job].size(); index++)
+					m_Graph.InsertEdge(rowEdges[job][index].indexA, rowEdges[job][index].indexB, rowEdges[job][index].weight);
+		}
+	}
 
-				token.clear();
+	void CreateSparseImpl(CsvReader& reader)
+	{
+		// one entry per line, blank lines and lines starting with # are skipped:
+		//   R1          declares a device
+		//   M1,R1,2.5   edge from M1 to R1 with a non-negative real weight, both devices declared above
+		// edges are directed like the cells of the dense matrix, so a link is written in both directions.
 
-				if(ch == ',')
-					colIndex++;
+		Token line;
+		Array<Token> fields;
 
-				else if(ch == '\n')
-				{
-					rowIndex++;
-					colIndex = -1;
-				}
+		while(reader.ReadLine(line))
+		{
+			if(line.empty() || line.front() == '#')
+				continue;
 
-				else if(!fin)
-					break;
+			line.split(',', fields);
+
+			if(fields.size() == 1)
+				InsertDevice(fields[0].str());
+
+			else if(fields.size() == 3)
+			{
+				// splaying search while loading, names are often declared in sorted order
+
+				int* indexA = m_Map.search(fields[0].str());
+				int* indexB = m_Map.search(fields[1].str());
+				double weight = 0.0;
+				ErrorAbort(!(indexA && indexB), "Network::CreateImpl() : edge between undeclared devices");
+				ErrorAbort(!fields[2].ToReal(weight), "Network::CreateImpl() : invalid edge weight");
+				m_Graph.InsertEdge(*indexA, *indexB, weight);
 			}
+
 			else
-				token.InsertBack(ch);
+				ErrorAbort(true, "Network::CreateImpl() : invalid edge list line");
 		}
+	}
 
-		m_RoutingTableType = routingTableType;
+	void InsertDevice(const String& name)
+	{
+		Device* device = nullptr;
+
+		if(ToUpper(name.front()) == 'M')
+			device = new Machine(name);
+
+		else if(ToUpper(name.front()) == 'R')
+			device = new Router(name);
+
+		else
+			ErrorAbort(true, "Network::CreateImpl() : invalid network device type");
+
+		int deviceIndex = m_Graph.InsertVertex(device);
+		device->SetID(deviceIndex);
+
+		if(!m_Map.insert({name, deviceIndex}))
+		{
+			delete device;
+			ErrorAbort(true, "Network::CreateImpl() : duplicate device inserted");
+		}
 	}
 
 	void DeleteImpl()
@@ -277,6 +567,190 @@ private:
 
 		m_Graph.clear();
 		m_Map.clear();
+		m_NetMap.clear();
+		m_Events.clear();
+		m_Busy.clear();
+		m_Trees.clear();
+		m_RouterIndices.clear();
+		m_SourceSize = -1;
+		m_SourceTime = 0;
+		ClosePathLog();
+	}
+
+	// snapshot implementation
+
+	bool SaveSnapshotImpl(const String& filepath) const
+	{
+		// needs a loaded network with its shortest paths and no removed devices, see CompactDevices()
+
+		if(Empty() || m_Trees.size() != DeviceCount() || m_Graph.LiveVertexCount() != DeviceCount())
+			return false;
+
+		const CompressedGraph& graph = m_Graph.GetCompressed();
+		int deviceCount = DeviceCount();
+
+		SnapshotHeader header;
+		std::memcpy(header.magic, SnapshotMagic(), sizeof(header.magic));
+		header.version = snapshotVersion;
+		header.deviceCount = deviceCount;
+		header.edgeCount = graph.EdgeCount();
+		header.routerCount = m_RouterIndices.size();
+		header.sourceSize = m_SourceSize;
+		header.sourceTime = m_SourceTime;
+
+		// device names, back to back
+
+		Array<int> nameOffsets(deviceCount + 1, 0);
+		String names;
+
+		for(int index = 0; index < deviceCount; index++)
+		{
+			names += GetDevice(index)->GetAddress();
+			nameOffsets[index + 1] = names.size();
+		}
+
+		header.nameBytes = names.size();
+
+		// compressed adjacency
+
+		Array<int> edgeOffsets(deviceCount + 1);
+		Array<int> targets(graph.EdgeCount());
+		Array<double> weights(graph.EdgeCount());
+
+		for(int index = 0; index <= deviceCount; index++)
+			edgeOffsets[index] = (index < deviceCount) ? graph.FirstEdge(index) : graph.EdgeCount();
+
+		for(int slot = 0; slot < graph.EdgeCount(); slot++)
+		{
+			targets[slot] = graph.GetTarget(slot);
+			weights[slot] = graph.GetWeight(slot);
+		}
+
+		// write sections, padding each to the layout's boundary
+
+		std::ofstream fout(filepath.data(), std::ios::binary | std::ios::trunc);
+
+		if(!fout)
+			return false;
+
+		long long position = 0;
+
+		auto writeSection = [&](const void* data, long long bytes)
+		{
+			const char padding[8]{};
+			fout.write(static_cast<const char*>(data), bytes);
+			position += bytes;
+
+			long long aligned = SnapshotLayout::AlignSection(position);
+			fout.write(padding, aligned - position);
+			position = aligned;
+		};
+
+		writeSection(&header, sizeof(header));
+		writeSection(nameOffsets.data(), sizeof(int) * nameOffsets.size());
+		writeSection(names.data(), names.size());
+		writeSection(edgeOffsets.data(), sizeof(int) * edgeOffsets.size());
+		writeSection(targets.data(), sizeof(int) * targets.size());
+		writeSection(weights.data(), sizeof(double) * weights.size());
+		writeSection(m_RouterIndices.data(), sizeof(int) * m_RouterIndices.size());
+
+		for(int job = 0; job < m_RouterIndices.size(); job++)
+		{
+			const ShortestPathTree& tree = m_Trees[m_RouterIndices[job]];
+			writeSection(tree.distances.data(), sizeof(double) * deviceCount);
+			writeSection(tree.parents.data(), sizeof(int) * deviceCount);
+			writeSection(tree.nextHops.data(), sizeof(int) * deviceCount);
+		}
+
+		return bool(fout) && position == SnapshotLayout(header).size;
+	}
+
+	void LoadSnapshotImpl(const String& filepath, Router::TableType routingTableType)
+	{
+		// the file is mapped and its arrays are read in place, only routing tables are rebuilt
+
+		MappedFile file(filepath.data());
+		ErrorAbort(!file.IsOpen(), "Network::LoadSnapshotImpl() : failed to open file");
+		ErrorAbort(file.size() < (long long)sizeof(SnapshotHeader), "Network::LoadSnapshotImpl() : truncated snapshot");
+
+		SnapshotHeader header;
+		std::memcpy(&header, file.data(), sizeof(header));
+		ErrorAbort(std::memcmp(header.magic, SnapshotMagic(), sizeof(header.magic)) != 0, "Network::LoadSnapshotImpl() : not a snapshot");
+		ErrorAbort(header.version != snapshotVersion, "Network::LoadSnapshotImpl() : unsupported snapshot version");
+		ErrorAbort(header.deviceCount < 0 || header.edgeCount < 0 || header.routerCount < 0 || header.nameBytes < 0, "Network::LoadSnapshotImpl() : corrupt snapshot");
+
+		SnapshotLayout layout(header);
+		ErrorAbort(file.size() != layout.size, "Network::LoadSnapshotImpl() : snapshot size does not match its header");
+
+		int deviceCount = header.deviceCount;
+		m_SourceSize = header.sourceSize;
+		m_SourceTime = header.sourceTime;
+		const int* nameOffsets = reinterpret_cast<const int*>(file.data() + layout.nameOffsets);
+		const char* names = file.data() + layout.names;
+		const int* edgeOffsets = reinterpret_cast<const int*>(file.data() + layout.edgeOffsets);
+		const int* targets = reinterpret_cast<const int*>(file.data() + layout.targets);
+		const double* weights = reinterpret_cast<const double*>(file.data() + layout.weights);
+		const int* routers = reinterpret_cast<const int*>(file.data() + layout.routers);
+
+		// devices and edges
+
+		for(int index = 0; index < deviceCount; index++)
+		{
+			ErrorAbort(!(0 <= nameOffsets[index] && nameOffsets[index] < nameOffsets[index + 1] && nameOffsets[index + 1] <= header.nameBytes), "Network::LoadSnapshotImpl() : corrupt device names");
+
+			String name;
+			name.append(names + nameOffsets[index], nameOffsets[index + 1] - nameOffsets[index]);
+			InsertDevice(name);
+		}
+
+		m_Map.balance();
+		m_Graph.ReserveEdges(header.edgeCount);
+
+		for(int index = 0; index < deviceCount; index++)
+		{
+			ErrorAbort(!(0 <= edgeOffsets[index] && edgeOffsets[index] <= edgeOffsets[index + 1] && edgeOffsets[index + 1] <= header.edgeCount), "Network::LoadSnapshotImpl() : corrupt adjacency");
+
+			for(int slot = edgeOffsets[index]; slot < edgeOffsets[index + 1]; slot++)
+			{
+				// a negative weight would let the shortest paths loop
+
+				ErrorAbort(!(weights[slot] >= 0.0), "Network::LoadSnapshotImpl() : negative edge weight");
+				m_Graph.InsertEdge(index, targets[slot], weights[slot]);
+			}
+		}
+
+		m_RoutingTableType = routingTableType;
+		m_Busy = Array<bool>(deviceCount, false);
+		m_Graph.compress();
+		LinkDevices();
+		AssignNetAddresses();
+
+		// shortest path trees are copied out of the file, then each router publishes its table
+
+		ErrorAbort(m_RouterIndices.size() != header.routerCount, "Network::LoadSnapshotImpl() : router count does not match");
+
+		for(int job = 0; job < m_RouterIndices.size(); job++)
+			ErrorAbort(m_RouterIndices[job] != routers[job], "Network::LoadSnapshotImpl() : router order does not match");
+
+		m_Trees = Array<ShortestPathTree>(deviceCount);
+
+		m_ThreadPool.ParallelFor(m_RouterIndices.size(), [&](int job)
+		{
+			const char* block = file.data() + layout.trees + (layout.treeBytes * job);
+			ShortestPathTree& tree = m_Trees[m_RouterIndices[job]];
+
+			tree.distances.resize(deviceCount);
+			tree.parents.resize(deviceCount);
+			tree.nextHops.resize(deviceCount);
+
+			CopyArray(tree.distances.data(), reinterpret_cast<const double*>(block), deviceCount);
+			block += SnapshotLayout::AlignSection(sizeof(double) * deviceCount);
+			CopyArray(tree.parents.data(), reinterpret_cast<const int*>(block), deviceCount);
+			block += SnapshotLayout::AlignSection(sizeof(int) * deviceCount);
+			CopyArray(tree.nextHops.data(), reinterpret_cast<const int*>(block), deviceCount);
+
+			PublishRoutingTable(m_RouterIndices[job]);
+		});
 	}
 
 	// print implementation
@@ -287,6 +761,9 @@ private:
 
 		for(int index = 0; index < m_Graph.VertexCount(); index++)
 		{
+			if(!m_Graph.IsVertex(index))
+				continue;
+
 			const auto& vertex = m_Graph.GetVertex(index);
 			std::cout << "\n[" << vertex.data << ", " << vertex.data->GetAddress() << "]: ";
 
@@ -321,6 +798,23 @@ private:
 			std::cout << "\n";
 	}
 
+	void PrintNetAddressesImpl() const
+	{
+		std::cout << "\nNetwork Addresses\n";
+
+		for(int index = 0; index < DeviceCount(); index++)
+		{
+			if(!m_Graph.IsVertex(index))
+				continue;
+
+			Device* device = GetDevice(index);
+			std::cout << "\n[" << device->GetAddress() << ", " << FormatNetAddress(device->GetNetAddress()) << "]";
+		}
+
+		if(!Empty())
+			std::cout << "\n";
+	}
+
 	void PrintRoutingListsImpl() const
 	{
 		for(int index = 0; index < DeviceCount(); index++)
@@ -328,7 +822,8 @@ private:
 			if(Router* router = GetRouter(index))
 			{
 				std::cout << "\n" << router->GetAddress() << " Routing List\n";
-				const auto& list = router->GetRoutingList();
+				Router::TablePtr table = router->GetRoutingTable();
+				const auto& list = table->list;
 
 				for(auto field = list.first(); field.valid(); ++field)
 					std::cout << "\n[" << field->destAddress << ", " << field->nextAddress << "]";
@@ -346,7 +841,8 @@ private:
 			if(Router* router = GetRouter(index))
 			{
 				std::cout << "\n" << router->GetAddress() << " Routing Tree\n";
-				const auto& tree = router->GetRoutingTree();
+				Router::TablePtr table = router->GetRoutingTable();
+				const auto& tree = table->tree;
 				tree.PrintInOrder();
 
 				if(!tree.empty())
@@ -355,6 +851,68 @@ private:
 		}
 	}
 
+	void PrintRoutingHashesImpl() const
+	{
+		for(int index = 0; index < DeviceCount(); index++)
+		{
+			if(Router* router = GetRouter(index))
+			{
+				std::cout << "\n" << router->GetAddress() << " Routing Hash Table\n";
+				Router::TablePtr table = router->GetRoutingTable();
+				const auto& hash = table->hash;
+				hash.print();
+
+				if(!hash.empty())
+					std::cout << "\n";
+			}
+		}
+	}
+
+	void PrintRoutingDirectsImpl() const
+	{
+		for(int index = 0; index < DeviceCount(); index++)
+		{
+			if(Router* router = GetRouter(index))
+			{
+				std::cout << "\n" << router->GetAddress() << " Routing Direct Table\n";
+				Router::TablePtr table = router->GetRoutingTable();
+				const auto& direct = table->direct;
+				bool oneFound = false;
+
+				for(int destID = 0; destID < direct.size(); destID++)
+				{
+					if(direct[destID] != -1)
+					{
+						std::cout << "\n[" << GetDevice(destID)->GetAddress() << ", " << GetDevice(direct[destID])->GetAddress() << "]";
+						oneFound = true;
+					}
+				}
+
+				if(oneFound)
+					std::cout << "\n";
+			}
+		}
+	}
+
+	void PrintRoutingTriesImpl() const
+	{
+		for(int index = 0; index < DeviceCount(); index++)
+		{
+			if(Router* router = GetRouter(index))
+			{
+				std::cout << "\n" << router->GetAddress() << " Routing Trie\n";
+				Router::TablePtr table = router->GetRoutingTable();
+				const auto& routes = table->trie.GetRoutes();
+
+				for(int routeIndex = 0; routeIndex < routes.size(); routeIndex++)
+					std::cout << "\n[" << FormatNetAddress(routes[routeIndex].prefix, routes[routeIndex].length) << ", " << GetDevice(routes[routeIndex].value)->GetAddress() << "]";
+
+				if(!routes.empty())
+					std::cout << "\n";
+			}
+		}
+	}
+
 	// shortest paths implementation
 
 	static void MakePathList(const Array<int>& parentArray, int vertexIndex, List<int>& pathList)
@@ -384,82 +942,52 @@ private:
 		// parent of each vertex
 		Array<int> parents(DeviceCount(), -1);
 
-		// TODO: use build-heap method
-		PriorityQueue<LesserEqual<Pair<double, int>>> priorityQueue;
+		// vertices are queued once when first reached, unreachable ones never enter the queue
+		IndexedPriorityQueue<Lesser<double>> priorityQueue(DeviceCount());
+		priorityQueue.enqueue(startIndex, 0);
 
-		for(int index = 0; index < DeviceCount(); index++)
-			priorityQueue.enqueue({distances[index], index});
+		// edges are read from the contiguous compressed copy of the graph
+		const CompressedGraph& graph = m_Graph.GetCompressed();
 
-		// run until n devices are checked
-		for(int count = 0; count < DeviceCount(); count++)
+		// run until every reachable device is settled
+		while(!priorityQueue.empty())
 		{
 			// extract minimum distance
-			double currentDistance = priorityQueue.front().first;
-			int currentIndex = priorityQueue.front().second;
-			const auto& currentVertex = m_Graph.GetVertex(currentIndex);
+			int currentIndex = priorityQueue.front();
+			double currentDistance = distances[currentIndex];
 			priorityQueue.dequeue();
 
-			for(auto edge = currentVertex.edges.first(); edge.valid(); ++edge)
+			for(int edge = graph.FirstEdge(currentIndex); edge < graph.EndEdge(currentIndex); edge++)
 			{
 				// get neighbour data
-				double edgeWeight = edge->weight;
-				int neighbourIndex = edge->indexB;
+				double edgeWeight = graph.GetWeight(edge);
+				int neighbourIndex = graph.GetTarget(edge);
 				double& neighbourDistance = distances[neighbourIndex];
 
+				// settled neighbours already have their shortest distance
+				if(priorityQueue.settled(neighbourIndex))
+					continue;
+
 				// update distance and parent if shorter path found
 				if((currentDistance + edgeWeight) < neighbourDistance)
 				{
 					neighbourDistance = (currentDistance + edgeWeight);
 					parents[neighbourIndex] = currentIndex;
-					priorityQueue.enqueue({neighbourDistance, neighbourIndex});
-					// this creates duplicates in queue
-					// but they will not be checked later redundantly
-					// because we will stop at n devices
+
+					if(priorityQueue.contains(neighbourIndex))
+						priorityQueue.DecreaseKey(neighbourIndex, neighbourDistance);
+					else
+						priorityQueue.enqueue(neighbourIndex, neighbourDistance);
 				}
 			}
 		}
 
-		// fill routing lists and trees
-		{
-			Router::TableType tableType = m_RoutingTableType;
-			Router::List routingList;
-			Router::Tree routingTree;
-
-			for(int index = 0; index < DeviceCount(); index++)
-			{
-				// ignore router to router paths
-				Machine* machine = GetMachine(index);
-
-				if(!machine)
-					continue;
-
-				// find full path from source router to destination machine
-				List<int> path;
-				path.InsertFront(index);
-				MakePathList(parents, index, path);
-
-				// ignore if only start router itself exists in the path
-				if(path.size() == 1)
-					continue;
-
-				// insert routing fields
-				Device* nextDevice = GetDevice(*path.first().next());
-				Router::Field field = {machine->GetAddress(), nextDevice->GetAddress()};
-				
-				if(tableType == Router::TableType::List)
-					routingList.InsertBack(field);
-
-				else if(tableType == Router::TableType::Tree)
-					routingTree.insert({field.destAddress, field.nextAddress});
-			}
-
-			// insert routing tables
-			if(tableType == Router::TableType::List)
-				startRouter->SetRoutingList(routingList);
-
-			else if(tableType == Router::TableType::Tree)
-				startRouter->SetRoutingTree(routingTree);
-		}
+		// keep shortest path tree for later repairs
+		ShortestPathTree& tree = m_Trees[startIndex];
+		tree.distances = std::move(distances);
+		tree.parents = std::move(parents);
+		FindNextHops(tree, startIndex);
+		PublishRoutingTable(startIndex);
 
 		#if PRINT_SHORTEST_PATH_TABLE
 
@@ -467,6 +995,9 @@ private:
 
 		for(int index = 0; index < DeviceCount(); index++)
 		{
+			if(!m_Graph.IsVertex(index))
+				continue;
+
 			// device
 
 			Device* device = GetDevice(index);
@@ -474,18 +1005,18 @@ private:
 
 			// distance
 
-			if(distances[index] == infinity)
+			if(tree.distances[index] == infinity)
 				std::cout << "inf";
 			else
-				std::cout << distances[index];
+				std::cout << tree.distances[index];
 
 			// parent
 
-			if(parents[index] == -1)
+			if(tree.parents[index] == -1)
 				std::cout << "\t\t" << "None" << "\t\t";
 			else
 			{
-				device = GetDevice(parents[index]);
+				device = GetDevice(tree.parents[index]);
 				std::cout << "\t\t" << device->GetAddress() << "\t\t";
 			}
 
@@ -493,7 +1024,7 @@ private:
 
 			List<int> path;
 			path.InsertFront(index);
-			MakePathList(parents, index, path);
+			MakePathList(tree.parents, index, path);
 
 			for(auto deviceIndex = path.first(); deviceIndex.valid(); ++deviceIndex)
 			{
@@ -510,35 +1041,214 @@ private:
 		#endif
 	}
 
-	void FindShortestPathsImpl()
+	void PublishRoutingTable(int startIndex)
 	{
-		for(int index = 0; index < m_Graph.VertexCount(); index++)
-		{
-			auto& vertex = m_Graph.GetVertex(index);
-			Device* device = vertex.data;
+		// fills the router's table of the configured type from its shortest path tree
 
-			if(Machine* machine = DeviceToMachine(device))
-			{
+		const ShortestPathTree& tree = m_Trees[startIndex];
+		Router::TableType tableType = m_RoutingTableType;
+		Router::Table routingTable;
+		Array<bool> prefixInserted; // machines of one router share a single prefix
+
+		if(tableType == Router::TableType::Direct)
+			routingTable.direct = Router::Direct(DeviceCount(), -1);
+
+		else if(tableType == Router::TableType::Trie)
+			prefixInserted = Array<bool>(DeviceCount(), false);
+
+		for(int index = 0; index < DeviceCount(); index++)
+		{
+			// ignore router to router paths
+			Machine* machine = GetMachine(index);
+
+			if(!machine)
+				continue;
+
+			// ignore unreachable machines
+			if(tree.nextHops[index] == -1)
+				continue;
+
+			// insert routing fields
+			Device* nextDevice = GetDevice(tree.nextHops[index]);
+			Router::Field field = {machine->GetAddress(), nextDevice->GetAddress()};
+			
+			if(tableType == Router::TableType::List)
+				routingTable.list.InsertBack(field);
+
+			else if(tableType == Router::TableType::Tree)
+				routingTable.tree.insert({field.destAddress, field.nextAddress});
+
+			else if(tableType == Router::TableType::Hash)
+				routingTable.hash.insert({field.destAddress, field.nextAddress});
+
+			else if(tableType == Router::TableType::Direct)
+				routingTable.direct[index] = tree.nextHops[index];
+
+			else if(tableType == Router::TableType::Trie)
+			{
+				field = MakeField(startIndex, index, tree.nextHops[index]);
+
+				if(field.prefixLength == hostPrefixLength)
+					routingTable.trie.insert(field.destPrefix, field.prefixLength, field.nextID);
+
+				else if(!prefixInserted[machine->GetRouterID()])
+				{
+					routingTable.trie.insert(field.destPrefix, field.prefixLength, field.nextID);
+					prefixInserted[machine->GetRouterID()] = true;
+				}
+			}
+		}
+
+		GetRouter(startIndex)->SetRoutingTable(std::move(routingTable));
+	}
+
+	static void FindNextHops(ShortestPathTree& tree, int startIndex)
+	{
+		// walks up the parents of each vertex until a vertex with a known next hop is found, then fills the walked path.
+
+		const int unknown = -2;
+		tree.nextHops = Array<int>(tree.parents.size(), unknown);
+		tree.nextHops[startIndex] = -1;
+		Array<int> path;
+
+		for(int index = 0; index < tree.parents.size(); index++)
+		{
+			int current = index;
+
+			while(tree.nextHops[current] == unknown && tree.parents[current] != -1 && tree.parents[current] != startIndex)
+			{
+				path.InsertBack(current);
+				current = tree.parents[current];
+			}
+
+			int nextHop = tree.nextHops[current];
+
+			if(nextHop == unknown)
+				nextHop = (tree.parents[current] == startIndex) ? current : -1;
+
+			tree.nextHops[current] = nextHop;
+
+			for(int pathIndex = 0; pathIndex < path.size(); pathIndex++)
+				tree.nextHops[path[pathIndex]] = nextHop;
+
+			path.clear();
+		}
+	}
+
+	void FindShortestPathsImpl()
+	{
+		Array<int>& routerIndices = m_RouterIndices;
+		m_Trees = Array<ShortestPathTree>(m_Graph.VertexCount());
+		m_Graph.compress();
+		LinkDevices();
+		AssignNetAddresses();
+
+		#if PRINT_SHORTEST_PATH_TABLE
+
+		for(int job = 0; job < routerIndices.size(); job++)
+		{
+			std::cout << "\n" << GetDevice(routerIndices[job])->GetAddress() << " Paths\n";
+			std::cout << "\nAddress\t\tDistance\tParent\t\tPath\n\n";
+			FindShortestPathsImpl(routerIndices[job]);
+		}
+
+		#else
+
+		// each run only reads the graph and writes its own router's table
+
+		m_ThreadPool.ParallelFor(routerIndices.size(), [&](int job) { FindShortestPathsImpl(routerIndices[job]); });
+
+		#endif
+	}
+
+	void LinkDevices()
+	{
+		// machines learn their router, routers are listed for the shortest path runs
+
+		m_RouterIndices.clear();
+
+		for(int index = 0; index < m_Graph.VertexCount(); index++)
+		{
+			if(!m_Graph.IsVertex(index))
+				continue;
+
+			auto& vertex = m_Graph.GetVertex(index);
+			Device* device = vertex.data;
+
+			if(Machine* machine = DeviceToMachine(device))
+			{
 				ErrorAbort(vertex.edges.size() != 1, "Network::FindShortestPathsImpl() : machines must be connected to one router only");
 				int machineRouterIndex = vertex.edges.first()->indexB;
 				Router* machineRouter = GetRouter(machineRouterIndex);
 				machine->SetRouterAddress(machineRouter->GetAddress());
+				machine->SetRouterID(machineRouterIndex);
 			}
 
-			else if(Router* router = DeviceToRouter(device))
-			{
-				#if PRINT_SHORTEST_PATH_TABLE
+			else if(DeviceToRouter(device))
+				m_RouterIndices.InsertBack(index);
+		}
+	}
 
-				std::cout << "\n" << device->GetAddress() << " Paths\n";
-				std::cout << "\nAddress\t\tDistance\tParent\t\tPath\n\n";
+	// addressing implementation
 
-				#endif
+	void AssignNetAddresses()
+	{
+		// the k-th router owns the prefix 10.(k / 256).(k % 256).0/24 and takes its host 1,
+		// machines take the next free hosts of their router's prefix.
 
-				FindShortestPathsImpl(index);
+		constexpr unsigned prefixMask = 0xffffff00u;
+		constexpr int maxHost = 254;
+		m_NetMap.clear();
+		m_NetMap.reserve(DeviceCount());
+
+		Array<int> hostCounts(DeviceCount(), 1);
+
+		for(int job = 0; job < m_RouterIndices.size(); job++)
+		{
+			int routerNumber = job + 1;
+			ErrorAbort(routerNumber > 0xffff, "Network::AssignNetAddresses() : too many routers to address");
+
+			unsigned address = networkPrefix | (unsigned(routerNumber) << 8) | 1u;
+			GetDevice(m_RouterIndices[job])->SetNetAddress(address);
+			m_NetMap.insert({address, m_RouterIndices[job]});
+		}
+
+		for(int index = 0; index < DeviceCount(); index++)
+		{
+			if(Machine* machine = GetMachine(index))
+			{
+				int routerIndex = machine->GetRouterID();
+				ErrorAbort(++hostCounts[routerIndex] > maxHost, "Network::AssignNetAddresses() : too many machines on one router");
+
+				unsigned address = (GetDevice(routerIndex)->GetNetAddress() & prefixMask) | unsigned(hostCounts[routerIndex]);
+				machine->SetNetAddress(address);
+				m_NetMap.insert({address, index});
 			}
 		}
 	}
 
+	Router::Field MakeField(int routerIndex, int destIndex, int nextIndex) const
+	{
+		// machines of other routers are reached through their router's prefix, the router's own machines through host routes
+
+		constexpr unsigned prefixMask = 0xffffff00u;
+		Router::Field field = {GetDevice(destIndex)->GetAddress(), GetDevice(nextIndex)->GetAddress(), destIndex, nextIndex};
+		const Machine* machine = GetMachine(destIndex);
+
+		if(machine && machine->GetRouterID() != routerIndex)
+		{
+			field.destPrefix = GetDevice(machine->GetRouterID())->GetNetAddress() & prefixMask;
+			field.prefixLength = routerPrefixLength;
+		}
+		else
+		{
+			field.destPrefix = GetDevice(destIndex)->GetNetAddress();
+			field.prefixLength = hostPrefixLength;
+		}
+
+		return field;
+	}
+
 	// send msg implementation
 
 	void SendMsgImpl(List<Message> msgList, const String& filepath)
@@ -546,96 +1256,184 @@ private:
 		std::cout << "\nMessage Transfer Log\n";
 		SendMsgInit(msgList);
 
+		auto startClock = std::chrono::steady_clock::now();
+		long long startCount = m_EventCount;
+
 		while(simulation::run_flag && !SendMsgFinished())
 		{
 			SendMsgCycle(filepath);
 		}
 
+		FlushPathLog();
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startClock);
+		std::cout << "\nProcessed " << (m_EventCount - startCount) << " events in " << elapsed.count() << " ms, virtual time " << m_Time << "\n";
 		simulation::run_flag = false;
 	}
 
-	void SendMsgInit(List<Message>& msgList)
+	void StreamInputMsgImpl(const MessageSource& source, const String& filepath)
 	{
-		// enqueue messages in incoming queues of source machines
+		// the source blocks until a line is entered, so it is read on this thread and the simulation runs on its own.
+		// each message is handed over as soon as it is read, the simulation is joined once the source is exhausted.
 
-		for(auto msg = msgList.first(); msg.valid(); ++msg)
+		SpscQueue<Message> queue(inputQueueCapacity);
+		std::atomic<bool> sourceOpen{true};
+
+		MessageSource queueSource = [&queue](Message& msg)
+		{ return queue.pop(msg); };
+
+		std::thread simulationThread(&Network::StreamMsgImpl, this, queueSource, filepath, &sourceOpen);
+		Message msg;
+
+		while(simulation::run_flag && source(msg))
 		{
-			if(Machine* machine = GetMachine(msg->srcAddress))
+			while(!queue.push(std::move(msg)) && simulation::run_flag)
+				std::this_thread::yield();
+		}
+
+		sourceOpen = false;
+		simulationThread.join();
+	}
+
+	void StreamMsgImpl(MessageSource source, const String& filepath, const std::atomic<bool>* readerOpen)
+	{
+		// injection pauses while too many messages are in flight, so memory stays bounded however long the source is.
+		// with a reader thread the source only returns what has been read so far, and is exhausted once the reader
+		// is closed and the source runs dry.
+
+		std::cout << "\nMessage Transfer Log\n";
+
+		auto startClock = std::chrono::steady_clock::now();
+		long long startCount = m_EventCount;
+		long long msgCount = 0;
+		bool sourceOpen = true;
+		m_InFlight = 0;
+
+		while(simulation::run_flag && (sourceOpen || !SendMsgFinished()))
+		{
+			// a batch is read before the lock is taken, injecting under the lock keeps a paused simulation paused
+
+			List<Message> batch;
+
+			for(int count = 0; sourceOpen && count < simulation::batch_size && m_InFlight + count < simulation::max_in_flight; count++)
 			{
-				msg->trace = msg->srcAddress;
-				machine->InsertMessage(*msg);
-				std::cout << "\nInserted message " << msg->ID << " in " << machine->GetAddress();
+				// the reader closes only after its last message is pushed, so it is checked before the source
+
+				bool readerDone = readerOpen && !*readerOpen;
+				Message msg;
+
+				if(source(msg))
+					batch.InsertBack(std::move(msg));
+				else
+				{
+					sourceOpen = readerOpen && !readerDone;
+					break;
+				}
 			}
-			else ErrorAbort(true, "Network::SendMsgInit() : machine not found");
+
+			if(!batch.empty())
+			{
+				simulation::lock.lock();
+				simulation::lock_flag = true;
+
+				for(auto msg = batch.first(); msg.valid(); ++msg)
+				{
+					if(SendMsgInject(std::move(*msg)))
+						msgCount++;
+					else
+						std::cout << "\nSkipped message " << msg->ID << ", machine " << msg->srcAddress << " not found\n";
+				}
+
+				if(simulation::lock_flag)
+				{
+					simulation::lock.unlock();
+					simulation::lock_flag = false;
+				}
+			}
+
+			// nothing to inject or forward while the reader waits for input
+
+			else if(readerOpen && m_Events.empty())
+			{
+				std::this_thread::sleep_for(1ms);
+				continue;
+			}
+
+			SendMsgCycle(filepath);
 		}
 
+		FlushPathLog();
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startClock);
+		std::cout << "\nStreamed " << msgCount << " messages, processed " << (m_EventCount - startCount) << " events in " << elapsed.count() << " ms, virtual time " << m_Time << "\n";
+		simulation::run_flag = false;
+	}
+
+	void SendMsgInit(List<Message>& msgList)
+	{
+		m_InFlight = 0;
+
+		for(auto msg = msgList.first(); msg.valid(); ++msg)
+			ErrorAbort(!SendMsgInject(std::move(*msg)), "Network::SendMsgInit() : machine not found");
+
 		if(!msgList.empty())
 			std::cout << "\n";
 	}
 
+	bool SendMsgInject(Message&& msg)
+	{
+		// schedule arrival of message at its source machine at the current virtual time, the message is left
+		// untouched if its source is not a machine
+
+		int machineIndex = GetDeviceIndex(msg.srcAddress);
+
+		if(machineIndex != -1 && GetMachine(machineIndex))
+		{
+			// numeric addresses are logged by device name
+			msg.srcAddress = GetDeviceName(msg.srcAddress);
+			msg.dstAddress = GetDeviceName(msg.dstAddress);
+			msg.trace.clear();
+			msg.trace.InsertBack(machineIndex, m_Time);
+			msg.srcID = machineIndex;
+			msg.dstID = GetDeviceIndex(msg.dstAddress);
+			std::cout << "\nInserted message " << msg.ID << " in " << msg.srcAddress;
+			ScheduleEvent(m_Time, Event::Type::Arrival, machineIndex, std::move(msg));
+			m_InFlight++;
+			return true;
+		}
+
+		return false;
+	}
+
 	void SendMsgCycle(const String& filepath)
 	{
+		// fast mode processes a batch of events per lock, display mode processes one event at a time
+
 		simulation::lock.lock();
 		simulation::lock_flag = true;
 
-		for(int deviceIndex = 0; deviceIndex < DeviceCount(); deviceIndex++)
+		for(int count = 0; count < simulation::batch_size && !m_Events.empty(); count++)
 		{
-			if(Machine* machine = GetMachine(deviceIndex))
+			if(simulation::display_flag && m_Events.front().time > m_Time)
 			{
-				if(machine->ReadMessage())
-				{
-					// machine in-queue to out-queue
-					Message msg = machine->GetOutQueue().back();
-					std::cout << "\n" << machine->GetAddress() << " picked up message " << msg.ID;
-					
-					// machine out-queue to router in-queue
-					if(msg.srcAddress == machine->GetAddress())
-					{
-						Router* router = GetRouter(machine->GetRouterAddress());
-						machine->RemoveMessage();
-						msg.trace += (":" + router->GetAddress());
-						router->InsertMessage(msg);
-						std::cout << "\n" << machine->GetAddress() << " transferred message " << msg.ID << " to " << router->GetAddress() << "\n";
-						
-						simulation::lock.unlock();
-						simulation::lock_flag = false;
-						std::this_thread::sleep_for(1s);
-						simulation::lock.lock();
-						simulation::lock_flag = true;
-					}
+				auto pace = simulation::display_pace * (m_Events.front().time - m_Time);
+				m_Time = m_Events.front().time;
 
-					// message reached destination machine
-					else if(msg.dstAddress == machine->GetAddress())
-					{
-						machine->RemoveMessage();
-						std::cout << "\n" << machine->GetAddress() << " received message " << msg.ID << " from " << msg.trace << " \"" << msg.payload << "\"\n";
-						SendMsgWritePath(filepath, msg);
-					}
-				}
+				simulation::lock.unlock();
+				simulation::lock_flag = false;
+				std::this_thread::sleep_for(pace);
+				return;
 			}
 
-			else if(Router* router = GetRouter(deviceIndex))
-			{
-				if(router->ReadMessage())
-				{
-					// router in-queue to out-queue
-					Message msg = router->GetOutQueue().back();
-					std::cout << "\n" << router->GetAddress() << " picked up message " << msg.ID;
+			Event event = m_Events.extract();
+			m_Time = event.time;
+			m_EventCount++;
 
-					// router out-queue to next device in-queue
-					Device* nextDevice = GetDevice(router->RoutingDecision(msg.dstAddress, m_RoutingTableType));
-					router->RemoveMessage();
-					msg.trace += (":" + nextDevice->GetAddress());
-					nextDevice->InsertMessage(msg);
-					std::cout << "\n" << router->GetAddress() << " transferred message " << msg.ID << " to " << nextDevice->GetAddress() << "\n";
+			if(event.type == Event::Type::Arrival)
+				SendMsgArrival(event);
+			else
+				SendMsgService(event, filepath);
 
-					simulation::lock.unlock();
-					simulation::lock_flag = false;
-					std::this_thread::sleep_for(1s);
-					simulation::lock.lock();
-					simulation::lock_flag = true;
-				}
-			}
+			if(simulation::display_flag)
+				break;
 		}
 
 		if(simulation::lock_flag)
@@ -645,30 +1443,172 @@ private:
 		}
 	}
 
+	void SendMsgArrival(Event& event)
+	{
+		// message enters the in-queue, device starts serving it if idle
+
+		Device* device = GetDevice(event.deviceIndex);
+		device->InsertMessage(std::move(event.msg));
+
+		if(!m_Busy[event.deviceIndex])
+		{
+			m_Busy[event.deviceIndex] = true;
+			ScheduleEvent(m_Time, Event::Type::Service, event.deviceIndex);
+		}
+	}
+
+	void SendMsgService(const Event& event, const String& filepath)
+	{
+		// device forwards one message per unit of time, messages travel for the weight of the link
+
+		constexpr double serviceTime = 1.0;
+		Device* device = GetDevice(event.deviceIndex);
+
+		if(!device->ReadMessage())
+		{
+			m_Busy[event.deviceIndex] = false;
+			return;
+		}
+
+		Message msg = device->TakeMessage();
+
+		if(simulation::display_flag)
+			std::cout << "\n" << device->GetAddress() << " picked up message " << msg.ID;
+
+		int nextIndex = -1;
+
+		if(Machine* machine = DeviceToMachine(device))
+		{
+			// machine out-queue to router in-queue
+			if(msg.srcID == event.deviceIndex)
+				nextIndex = machine->GetRouterID();
+
+			// message reached destination machine
+			else if(msg.dstID == event.deviceIndex)
+			{
+				std::cout << "\n" << machine->GetAddress() << " received message " << msg.ID << " from " << RenderTrace(msg.trace) << " \"" << msg.payload << "\"\n";
+				SendMsgWritePath(filepath, msg);
+			}
+		}
+
+		// router out-queue to next device in-queue
+		else if(Router* router = DeviceToRouter(device))
+		{
+			if(m_RoutingTableType == Router::TableType::Direct)
+				nextIndex = router->RoutingDecision(msg.dstID);
+
+			else if(m_RoutingTableType == Router::TableType::Trie)
+				nextIndex = (msg.dstID != -1) ? router->PrefixDecision(GetDevice(msg.dstID)->GetNetAddress()) : -1;
+
+			else
+				nextIndex = GetDeviceIndex(router->RoutingDecision(msg.dstAddress, m_RoutingTableType));
+
+			if(nextIndex == -1)
+				std::cout << "\n" << router->GetAddress() << " dropped message " << msg.ID << ", no route to " << msg.dstAddress << "\n";
+		}
+
+		// a routing table may name a next hop that is not linked to this device
+		double linkWeight = 0.0;
+
+		if(nextIndex != -1)
+		{
+			auto edge = m_Graph.GetEdge(event.deviceIndex, nextIndex);
+
+			if(edge.valid())
+				linkWeight = edge->weight;
+
+			else
+			{
+				std::cout << "\n" << device->GetAddress() << " dropped message " << msg.ID << ", no link to " << GetDevice(nextIndex)->GetAddress() << "\n";
+				nextIndex = -1;
+			}
+		}
+
+		// message left the network
+		if(nextIndex == -1)
+			m_InFlight--;
+
+		else
+		{
+			Device* nextDevice = GetDevice(nextIndex);
+			double arrivalTime = m_Time + linkWeight;
+			msg.trace.InsertBack(nextIndex, arrivalTime);
+
+			if(simulation::display_flag)
+				std::cout << "\n" << device->GetAddress() << " transferred message " << msg.ID << " to " << nextDevice->GetAddress() << "\n";
+
+			ScheduleEvent(arrivalTime, Event::Type::Arrival, nextIndex, std::move(msg));
+		}
+
+		ScheduleEvent(m_Time + serviceTime, Event::Type::Service, event.deviceIndex);
+	}
+
 	void SendMsgWritePath(const String& filepath, const Message& msg)
 	{
-		std::ofstream fout(filepath.data(), std::ios::app);
-		fout << msg.ID << ":" << msg.trace << "\n";
+		OpenPathLogImpl(filepath);
+		PathLogSpan span;
+
+		if(m_PathEncoder.IsOpen())
+			span = m_PathEncoder.append(msg.ID, msg.trace, [this](int deviceID) -> const String& { return GetDevice(deviceID)->GetAddress(); });
+
+		else
+		{
+			String line = NumToStr(msg.ID);
+			line += ':';
+			line += RenderTrace(msg.trace);
+			line += '\n';
+
+			span.size = line.size();
+			span.offset = m_PathLog.push(std::move(line));
+		}
+
+		if(msg.trace.size() >= 2)
+			m_PathIndex.insert(GetDevice(msg.trace.front().deviceID)->GetAddress(), GetDevice(msg.trace.back().deviceID)->GetAddress(), span.offset, span.size);
 	}
 
-	bool SendMsgFinished()
+	String RenderTrace(const Trace& trace) const
 	{
-		for(int deviceIndex = 0; deviceIndex < DeviceCount(); deviceIndex++)
+		// device addresses joined by ':'
+
+		String result;
+
+		for(int index = 0; index < trace.size(); index++)
 		{
-			if(Device* device = GetDevice(deviceIndex))
-				if(!device->GetOutQueue().empty())
-					return false;
+			if(index)
+				result += ':';
+
+			result += GetDevice(trace[index].deviceID)->GetAddress();
+		}
+
+		return result;
+	}
 
-			if(Machine* machine = GetMachine(deviceIndex))
-				if(!machine->GetInQueue().empty())
-					return false;
+	bool SendMsgFinished() const
+	{ return m_Events.empty(); }
 
-			if(Router* router = GetRouter(deviceIndex))
-				if(!router->GetInQueue().empty())
-					return false;
+	void ScheduleEvent(double time, Event::Type type, int deviceIndex, Message&& msg = {})
+	{ m_Events.enqueue({time, m_EventSequence++, type, deviceIndex, std::move(msg)}); }
+
+	int GetDeviceIndex(const String& deviceAddress) const
+	{
+		// device name or numeric address, const so that lookups from several threads never splay the map
+
+		if(StrIsNetAddress(deviceAddress.data()))
+		{
+			auto search = m_NetMap.search(StrToNetAddress(deviceAddress.data()));
+			return search ? *search : -1;
 		}
 
-		return true;
+		auto search = m_Map.search(deviceAddress);
+		return search ? *search : -1;
+	}
+
+	String GetDeviceName(const String& deviceAddress) const
+	{
+		// numeric addresses are converted to device names, anything else is kept
+
+		int deviceIndex = StrIsNetAddress(deviceAddress.data()) ? GetDeviceIndex(deviceAddress) : -1;
+		return (deviceIndex != -1) ? GetDevice(deviceIndex)->GetAddress() : deviceAddress;
 	}
 
 	// change rt implementation
@@ -680,110 +1620,182 @@ private:
 		if(router == nullptr)
 			return false;
 
-		Router::List savedList = router->GetRoutingList();
-		Router::Tree savedTree = router->GetRoutingTree();
+		// changes go to a copy, which is only published if every field is valid
 
-		for(auto field = fieldList.first(); field.valid(); ++field)
-		{
-			if(action == "add")
-				router->InsertField(*field, m_RoutingTableType);
+		Router::Table routingTable = *router->GetRoutingTable();
 
-			else if(action == "remove")
+		for(auto fieldIter = fieldList.first(); fieldIter.valid(); ++fieldIter)
+		{
+			// resolve device ids of the field, fields added by hand are host routes
+			Router::Field field = *fieldIter;
+			field.destID = GetDeviceIndex(field.destAddress);
+			field.nextID = GetDeviceIndex(field.nextAddress);
+			field.destAddress = GetDeviceName(field.destAddress);
+			field.nextAddress = GetDeviceName(field.nextAddress);
+
+			if(field.destID != -1)
 			{
-				if(!router->RemoveField(*field, m_RoutingTableType))
-				{
-					router->SetRoutingList(savedList);
-					router->SetRoutingTree(savedTree);
-					return false;
-				}
+				field.destPrefix = GetDevice(field.destID)->GetNetAddress();
+				field.prefixLength = hostPrefixLength;
 			}
+
+			bool needsIDs = (m_RoutingTableType == Router::TableType::Direct || m_RoutingTableType == Router::TableType::Trie);
+			bool valid = !needsIDs || (field.destID != -1 && field.nextID != -1);
+
+			if(valid && action == "add")
+				routingTable.InsertField(field, m_RoutingTableType);
+
+			else if(valid && action == "remove")
+				valid = routingTable.RemoveField(field, m_RoutingTableType);
+
+			if(!valid)
+				return false;
 		}
 
+		router->SetRoutingTable(std::move(routingTable));
 		return true;
 	}
 
+	// path log implementation
+
+	void OpenPathLogImpl(const String& filepath)
+	{
+		// the log stays open across runs, it is only reopened when another file is asked for.
+		// the index is brought up to date before the writer appends to the log.
+
+		if(m_PathLog.IsOpen() && m_PathLog.GetPath() == filepath)
+			return;
+
+		ClosePathLog();
+		m_PathIndex.open(filepath);
+		ErrorAbort(!m_PathLog.open(filepath, pathLogPolicy), "Network::OpenPathLogImpl() : failed to open path log");
+
+		if(PathLog::IsBinaryName(filepath))
+			m_PathEncoder.open(m_PathLog);
+	}
+
+	void FlushPathLog()
+	{
+		// the open block of a binary log is sealed, so every delivered path can be read back
+
+		m_PathEncoder.seal();
+		m_PathLog.flush();
+		m_PathIndex.save();
+	}
+
+	void ClosePathLog()
+	{
+		m_PathEncoder.close();
+		m_PathLog.close();
+		m_PathIndex.close();
+	}
+
 	// print path implementation
 
-	void PrintPathImpl(const String& srcAddress, const String& dstAddress, const String& filepath) const
+	void PrintPathImpl(const String& srcAddress, const String& dstAddress, const String& filepath)
 	{
-		std::ifstream fin(filepath.data());
+		// only the indexed records of the matching pairs are read from the log
+
+		OpenPathLogImpl(filepath);
+		PathLogReader reader(filepath);
 		
-		if(!fin)
+		if(!reader.IsOpen())
 		{
 			std::cout << "\nFailed to open " << filepath << "\n";
 			return;
 		}
 
+		auto records = m_PathIndex.search(srcAddress, dstAddress);
 		String line;
 		bool oneFound = false;
 
 		std::cout << "\nMessages sent from " << srcAddress << " to " << dstAddress << "\n";
 
-		while(true)
+		for(int index = 0; index < records.size(); index++)
 		{
-			char ch = fin.get();
-
-			if(!fin)
+			// records of a running simulation may not be written yet, later records are not either
+			if(!reader.ReadRecordAt(records[index], line))
 				break;
 
-			if(ch == '\n')
-			{
-				auto tokens = line.split(':');
-				bool validSize = (tokens.size() >= 3);
-				bool validSrc = (srcAddress == "*" || tokens[1] == srcAddress);
-				bool validDst = (dstAddress == "*" || tokens.back() == dstAddress);
+			std::cout << "\n" << line;
+			oneFound = true;
+		}
 
-				if(validSize && validSrc && validDst)
-				{
-					for(int index = 0; index < tokens.size(); index++)
-					{
-						if(index == 0)
-							std::cout << "\n";
-						else
-							std::cout << ":";
+		if(oneFound)
+			std::cout << "\n";
+	}
 
-						std::cout << tokens[index];
-						oneFound = true;
-					}
-				}
+	// export path implementation
 
-				line.clear();
-			}
+	long long ExportPathImpl(const String& logpath, const String& filepath)
+	{
+		// writes the text form of every record of the log, returns the records written or -1
 
-			else
-				line.InsertBack(ch);
+		OpenPathLogImpl(logpath);
+		FlushPathLog();
+
+		PathLogReader reader(logpath);
+		std::ofstream fout(filepath.data(), std::ios::binary | std::ios::trunc);
+
+		if(!reader.IsOpen() || !fout)
+			return -1;
+
+		PathRecord record;
+		String buffer;
+		long long count = 0;
+
+		while(reader.ReadRecord(record))
+		{
+			buffer += record.line;
+			buffer += '\n';
+			count++;
+
+			if(buffer.size() >= LogWriter::bufferSize)
+			{
+				fout.write(buffer.data(), buffer.size());
+				buffer.clear();
+			}
 		}
 
-		if(oneFound)
-			std::cout << "\n";
+		fout.write(buffer.data(), buffer.size());
+		return fout ? count : -1;
 	}
 
 	// change edge implementation
 
 	bool ChangeEdgeImpl(const String& srcAddress, const String& dstAddress, double edgeWeight)
 	{
-		auto indexA = m_Map.search(srcAddress);
-		auto indexB = m_Map.search(dstAddress);
+		int indexA = GetDeviceIndex(srcAddress);
+		int indexB = GetDeviceIndex(dstAddress);
 
-		if(!(indexA && indexB))
+		if(indexA == -1 || indexB == -1 || edgeWeight < 0.0)
 			return false;
 
-		auto edgeAB = m_Graph.GetEdge(*indexA, *indexB);
-		auto edgeBA = m_Graph.GetEdge(*indexB, *indexA);
+		auto edgeAB = m_Graph.GetEdge(indexA, indexB);
+		auto edgeBA = m_Graph.GetEdge(indexB, indexA);
 
 		if(!(edgeAB.valid() && edgeBA.valid()))
 			return false;
 
-		edgeAB->weight = edgeWeight;
-		edgeBA->weight = edgeWeight;
+		List<EdgeChange> changeList;
+		changeList.InsertBack({indexA, indexB, edgeAB->weight, edgeWeight});
+		changeList.InsertBack({indexB, indexA, edgeBA->weight, edgeWeight});
+		ApplyEdgeChanges(changeList);
 		return true;
 	}
 
 	bool ChangeEdgeImpl(const List<Graph::Edge>& edgeList)
 	{
+		// all edges are validated before any of them is changed
+
+		List<EdgeChange> changeList;
+
 		for(auto edgeIter = edgeList.first(); edgeIter.valid(); ++edgeIter)
 		{
-			if(!(InRange(edgeIter->indexA, 0, DeviceCount()) && InRange(edgeIter->indexB, 0, DeviceCount())))
+			if(!(InRange(edgeIter->indexA, 0, DeviceCount() - 1) && InRange(edgeIter->indexB, 0, DeviceCount() - 1)))
+				return false;
+
+			if(edgeIter->weight < 0.0)
 				return false;
 
 			auto edgeAB = m_Graph.GetEdge(edgeIter->indexA, edgeIter->indexB);
@@ -791,9 +1803,310 @@ private:
 			if(!edgeAB.valid())
 				return false;
 
-			edgeAB->weight = edgeIter->weight;
+			changeList.InsertBack({edgeIter->indexA, edgeIter->indexB, edgeAB->weight, edgeIter->weight});
 		}
 
+		ApplyEdgeChanges(changeList);
 		return true;
 	}
+
+	void ApplyEdgeChanges(const List<EdgeChange>& changeList)
+	{
+		for(auto change = changeList.first(); change.valid(); ++change)
+		{
+			m_Graph.SetWeight(change->indexA, change->indexB, change->newWeight);
+
+			#if DYNAMIC_SHORTEST_PATHS
+
+			UpdateShortestPathsImpl(*change);
+
+			#endif
+		}
+
+		#if !DYNAMIC_SHORTEST_PATHS
+
+		FindShortestPathsImpl();
+
+		#endif
+	}
+
+	// remove device implementation
+
+	bool RemoveDeviceImpl(const String& deviceAddress)
+	{
+		// the device's slot becomes a tombstone, so every other device keeps its id. a router is only removed
+		// once its machines are, and nothing is removed while messages are in flight.
+
+		constexpr double infinity = std::numeric_limits<double>::max();
+		int deviceIndex = GetDeviceIndex(deviceAddress);
+
+		if(deviceIndex == -1 || !m_Events.empty())
+			return false;
+
+		Device* device = GetDevice(deviceIndex);
+
+		if(DeviceToRouter(device))
+			for(int index = 0; index < DeviceCount(); index++)
+				if(Machine* machine = GetMachine(index))
+					if(machine->GetRouterID() == deviceIndex)
+						return false;
+
+		// its links are cut first, while routes through it can still name it. every tree reaching it is
+		// repaired as if the link to it had become infinitely costly.
+
+		m_Graph.RemoveEdges(deviceIndex);
+		m_Graph.compress();
+
+		m_ThreadPool.ParallelFor(m_RouterIndices.size(), [&](int job)
+		{
+			int routerIndex = m_RouterIndices[job];
+			ShortestPathTree& tree = m_Trees[routerIndex];
+
+			if(routerIndex == deviceIndex || tree.parents[deviceIndex] == -1)
+				return;
+
+			Array<int> oldNextHops = std::move(tree.nextHops); // rebuilt below
+			RepairShortestPathTree(tree, {tree.parents[deviceIndex], deviceIndex, 0.0, infinity});
+			FindNextHops(tree, routerIndex);
+			PatchRoutingTable(GetRouter(routerIndex), oldNextHops, tree.nextHops);
+		});
+
+		// lookups stay read-only, so the map is balanced again after the splaying removal
+
+		m_Map.remove(device->GetAddress());
+		m_Map.balance();
+		m_NetMap.remove(device->GetNetAddress());
+		m_Trees[deviceIndex] = ShortestPathTree();
+		m_Busy[deviceIndex] = false;
+
+		int routerJob = m_RouterIndices.search(deviceIndex);
+
+		if(routerJob != -1)
+			m_RouterIndices.remove(routerJob);
+
+		m_Graph.RemoveVertex(deviceIndex);
+		m_Graph.compress();
+		delete device;
+		return true;
+	}
+
+	void CompactDevicesImpl()
+	{
+		// renumbers the devices past the tombstones in one batch, then finds every shortest path again
+
+		if(m_Graph.LiveVertexCount() == m_Graph.VertexCount())
+			return;
+
+		m_Graph.compact();
+		m_Map.clear();
+
+		for(int index = 0; index < DeviceCount(); index++)
+		{
+			Device* device = GetDevice(index);
+			device->SetID(index);
+			m_Map.insert({device->GetAddress(), index});
+		}
+
+		m_Map.balance();
+		m_Busy = Array<bool>(DeviceCount(), false);
+		FindShortestPathsImpl();
+	}
+
+	// dynamic shortest paths implementation
+
+	void UpdateShortestPathsImpl(const EdgeChange& change)
+	{
+		// only routers whose shortest path tree is affected by the change are repaired and patched
+
+		m_ThreadPool.ParallelFor(m_RouterIndices.size(), [&](int job)
+		{
+			int routerIndex = m_RouterIndices[job];
+			ShortestPathTree& tree = m_Trees[routerIndex];
+
+			if(!AffectsShortestPathTree(tree, change))
+				return;
+
+			Array<int> oldNextHops = std::move(tree.nextHops); // rebuilt below
+			RepairShortestPathTree(tree, change);
+			FindNextHops(tree, routerIndex);
+			PatchRoutingTable(GetRouter(routerIndex), oldNextHops, tree.nextHops);
+		});
+	}
+
+	static bool AffectsShortestPathTree(const ShortestPathTree& tree, const EdgeChange& change)
+	{
+		constexpr double infinity = std::numeric_limits<double>::max();
+		double distanceA = tree.distances[change.indexA];
+
+		if(distanceA == infinity)
+			return false;
+
+		// a cheaper edge matters only if it shortens the path to its end
+		if(change.newWeight < change.oldWeight)
+			return (distanceA + change.newWeight) < tree.distances[change.indexB];
+
+		// a costlier edge matters only if it is part of the tree
+		if(change.newWeight > change.oldWeight)
+			return tree.parents[change.indexB] == change.indexA;
+
+		return false;
+	}
+
+	void RepairShortestPathTree(ShortestPathTree& tree, const EdgeChange& change) const
+	{
+		constexpr double infinity = std::numeric_limits<double>::max();
+		Array<double>& distances = tree.distances;
+		Array<int>& parents = tree.parents;
+		IndexedPriorityQueue<Lesser<double>> priorityQueue(distances.size());
+		const CompressedGraph& graph = m_Graph.GetCompressed();
+
+		if(change.newWeight < change.oldWeight)
+		{
+			// edge end gets a shorter path, which is then spread to its descendants
+			distances[change.indexB] = distances[change.indexA] + change.newWeight;
+			parents[change.indexB] = change.indexA;
+			priorityQueue.enqueue(change.indexB, distances[change.indexB]);
+		}
+
+		else
+		{
+			// subtree under edge end loses its paths
+			Array<char> affected = FindSubtree(parents, change.indexB);
+
+			for(int index = 0; index < affected.size(); index++)
+			{
+				if(affected[index])
+				{
+					distances[index] = infinity;
+					parents[index] = -1;
+				}
+			}
+
+			// each lost vertex takes the best path offered by unaffected neighbours
+			Array<int> seeds;
+
+			for(int index = 0; index < affected.size(); index++)
+			{
+				if(!affected[index])
+					continue;
+
+				for(int edge = graph.FirstInEdge(index); edge < graph.EndInEdge(index); edge++)
+				{
+					int neighbourIndex = graph.GetSource(edge);
+
+					if(affected[neighbourIndex] || distances[neighbourIndex] == infinity)
+						continue;
+
+					double distance = distances[neighbourIndex] + graph.GetInWeight(edge);
+
+					if(distance < distances[index])
+					{
+						distances[index] = distance;
+						parents[index] = neighbourIndex;
+					}
+				}
+
+				if(distances[index] != infinity)
+					seeds.InsertBack(index);
+			}
+
+			priorityQueue.BuildHeap(seeds, distances);
+		}
+
+		// dijkstra from the changed vertices
+		while(!priorityQueue.empty())
+		{
+			int currentIndex = priorityQueue.front();
+			double currentDistance = distances[currentIndex];
+			priorityQueue.dequeue();
+
+			for(int edge = graph.FirstEdge(currentIndex); edge < graph.EndEdge(currentIndex); edge++)
+			{
+				int neighbourIndex = graph.GetTarget(edge);
+				double& neighbourDistance = distances[neighbourIndex];
+
+				if(!priorityQueue.settled(neighbourIndex) && (currentDistance + graph.GetWeight(edge)) < neighbourDistance)
+				{
+					neighbourDistance = (currentDistance + graph.GetWeight(edge));
+					parents[neighbourIndex] = currentIndex;
+
+					if(priorityQueue.contains(neighbourIndex))
+						priorityQueue.DecreaseKey(neighbourIndex, neighbourDistance);
+					else
+						priorityQueue.enqueue(neighbourIndex, neighbourDistance);
+				}
+			}
+		}
+	}
+
+	static Array<char> FindSubtree(const Array<int>& parents, int rootIndex)
+	{
+		// marks every vertex whose chain of parents passes through the root.
+
+		const char unknown = 0, inside = 1, outside = 2;
+		Array<char> state(parents.size(), unknown);
+		state[rootIndex] = inside;
+		Array<int> path;
+
+		for(int index = 0; index < parents.size(); index++)
+		{
+			int current = index;
+
+			while(state[current] == unknown && parents[current] != -1)
+			{
+				path.InsertBack(current);
+				current = parents[current];
+			}
+
+			char result = (state[current] == inside) ? inside : outside;
+			state[current] = result;
+
+			for(int pathIndex = 0; pathIndex < path.size(); pathIndex++)
+				state[path[pathIndex]] = result;
+
+			path.clear();
+		}
+
+		for(int index = 0; index < state.size(); index++)
+			state[index] = (state[index] == inside);
+
+		return state;
+	}
+
+	void PatchRoutingTable(Router* router, const Array<int>& oldNextHops, const Array<int>& newNextHops)
+	{
+		// the router's table is copied once and republished with all patches applied
+
+		Router::Table routingTable = *router->GetRoutingTable();
+		int routerIndex = router->GetID();
+		bool patched = false;
+
+		for(int index = 0; index < DeviceCount(); index++)
+		{
+			Machine* machine = GetMachine(index);
+
+			if(!machine || oldNextHops[index] == newNextHops[index])
+				continue;
+
+			// machines sharing a prefix patch the same trie route, which is harmless
+
+			if(newNextHops[index] == -1)
+			{
+				// a trie prefix route is shared by the machines of one router, it goes once the router is unreachable
+
+				Router::Field field = MakeField(routerIndex, index, oldNextHops[index]);
+
+				if(m_RoutingTableType != Router::TableType::Trie || field.prefixLength == hostPrefixLength || newNextHops[machine->GetRouterID()] == -1)
+					routingTable.RemoveField(field, m_RoutingTableType);
+			}
+
+			else
+				routingTable.InsertField(MakeField(routerIndex, index, newNextHops[index]), m_RoutingTableType);
+
+			patched = true;
+		}
+
+		if(patched)
+			router->SetRoutingTable(std::move(routingTable));
+	}
 };
@@ -12,6 +12,8 @@ protected:
 	// members
 
 	String m_Address;
+	int m_ID = -1; // dense id interned by the network, equal to the device's graph index
+	unsigned m_NetAddress = 0; // hierarchical numeric address assigned by the network
 	Queue<Message> m_OutQueue;
 
 public:
@@ -27,6 +29,12 @@ public:
 	const String& GetAddress() const
 	{ return m_Address; }
 
+	int GetID() const
+	{ return m_ID; }
+
+	unsigned GetNetAddress() const
+	{ return m_NetAddress; }
+
 	const Queue<Message>& GetOutQueue() const
 	{ return m_OutQueue; }
 
@@ -35,12 +43,27 @@ public:
 	void SetAddress(const String& address)
 	{ m_Address = address; }
 
+	void SetID(int ID)
+	{ m_ID = ID; }
+
+	void SetNetAddress(unsigned netAddress)
+	{ m_NetAddress = netAddress; }
+
 	// messages
 
 	virtual void InsertMessage(const Message&) = 0;
+	virtual void InsertMessage(Message&&) = 0;
 	virtual bool ReadMessage() = 0;
 	virtual bool RemoveMessage() = 0;
 
+	Message TakeMessage()
+	{
+		// removes the message read into the out-queue and hands it over without copying
+
+		ErrorAbort(m_OutQueue.empty(), "NetworkDevice::TakeMessage() : out-queue is empty");
+		return m_OutQueue.extract();
+	}
+
 	// destructor
 
 	virtual ~NetworkDevice() = default;
@@ -17,6 +17,10 @@ struct Pair
 	Pair(const T1& first, const T2& second)
 		: first(first), second(second)
 	{}
+
+	Pair(T1&& first, T2&& second)
+		: first(std::move(first)), second(std::move(second))
+	{}
 };
 
 // compare
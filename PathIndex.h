@@ -0,0 +1,349 @@
+#pragma once
+#include "util.h"
+#include "Pair.h"
+#include "Array.h"
+#include "String.h"
+#include "PriorityQueue.h"
+#include "HashTable.h"
+#include "MappedFile.h"
+#include "PathLog.h"
+#include <cstdio>
+
+class PathIndex
+{
+	// offsets of the path log records of every (source, destination) pair, so a query reads only its records.
+	// the index is kept in a file beside the log that only grows: a header, then one entry per record holding
+	// varints for the pair, the gap after the record before and the size, where the first entry of a pair names
+	// its devices. entries are saved after every run, and an index that is missing or does not match its log is
+	// rebuilt from the log when opened.
+
+public:
+
+	// types
+
+	using Record = PathLogSpan;
+
+private:
+
+	struct Entry
+	{
+		long long offset;
+		int size;
+		int pair;
+	};
+
+	struct Header
+	{
+		char magic[8];
+		int version;
+		int reserved;
+	};
+
+	struct PairRecords
+	{
+		String srcAddress;
+		String dstAddress;
+		Array<Record> records;
+	};
+
+	// constants
+
+	static constexpr int indexVersion = 2;
+
+	static const char* IndexMagic()
+	{ return "NSIMPIDX"; }
+
+	// members
+
+	String m_LogPath;
+	String m_IndexPath;
+	Array<PairRecords> m_Pairs;
+	HashTable<String, int> m_PairMap; // "src:dst" to pair
+	Array<Entry> m_Pending; // entries not saved yet
+	int m_SavedPairs = 0; // pairs whose names are in the index file
+	long long m_SavedEnd = 0; // end of the last record in the index file
+	long long m_Covered = 0; // log bytes indexed
+	mutable std::mutex m_Mutex; // records are inserted by the simulation thread while queries may run
+
+public:
+
+	// constructors and memory management
+
+	PathIndex() = default;
+
+	PathIndex(const PathIndex&) = delete;
+	PathIndex& operator=(const PathIndex&) = delete;
+
+	~PathIndex()
+	{ close(); }
+
+	// open and close
+
+	void open(const String& logpath)
+	{
+		// loads the index of logpath, bringing it up to date with the log
+
+		close();
+		std::lock_guard<std::mutex> guard(m_Mutex);
+		m_LogPath = logpath;
+		m_IndexPath = logpath + ".idx";
+
+		PathLogReader reader(logpath);
+
+		if(!LoadIndex() || !MatchesLog(reader))
+		{
+			clear();
+			RewriteHeader();
+		}
+
+		IndexLog(reader);
+		SaveIndex();
+	}
+
+	void close()
+	{
+		std::lock_guard<std::mutex> guard(m_Mutex);
+
+		if(m_LogPath.empty())
+			return;
+
+		SaveIndex();
+		clear();
+		m_LogPath.clear();
+		m_IndexPath.clear();
+	}
+
+	// access
+
+	bool IsOpen() const
+	{ return !m_LogPath.empty(); }
+
+	const String& GetPath() const
+	{ return m_LogPath; }
+
+	// insert
+
+	void insert(const String& srcAddress, const String& dstAddress, long long offset, int size)
+	{
+		std::lock_guard<std::mutex> guard(m_Mutex);
+		InsertRecord(srcAddress, dstAddress, offset, size);
+	}
+
+	// save
+
+	void save()
+	{
+		std::lock_guard<std::mutex> guard(m_Mutex);
+		SaveIndex();
+	}
+
+	// search
+
+	Array<Record> search(const String& srcAddress, const String& dstAddress) const
+	{
+		// records of the matching pairs in log order, '*' matches any device
+
+		std::lock_guard<std::mutex> guard(m_Mutex);
+
+		if(srcAddress != "*" && dstAddress != "*")
+		{
+			const int* pair = m_PairMap.search(srcAddress + ":" + dstAddress);
+			return pair ? m_Pairs[*pair].records : Array<Record>();
+		}
+
+		// each pair is in log order, so the matching pairs are merged through a heap of their next records
+
+		using Cursor = Pair<long long, int>; // offset, pair
+		PriorityQueue<Lesser<Cursor>> heap;
+		Array<int> next(m_Pairs.size());
+		int count = 0;
+
+		for(int index = 0; index < m_Pairs.size(); index++)
+		{
+			const PairRecords& pair = m_Pairs[index];
+
+			if((srcAddress == "*" || pair.srcAddress == srcAddress) && (dstAddress == "*" || pair.dstAddress == dstAddress))
+			{
+				heap.enqueue(Cursor(pair.records[0].offset, index));
+				count += pair.records.size();
+			}
+		}
+
+		Array<Record> result;
+		result.reserve(count);
+
+		while(!heap.empty())
+		{
+			int index = heap.extract().second;
+			const Array<Record>& records = m_Pairs[index].records;
+			result.InsertBack(records[next[index]++]);
+
+			if(next[index] < records.size())
+				heap.enqueue(Cursor(records[next[index]].offset, index));
+		}
+
+		return result;
+	}
+
+private:
+
+	// index implementation
+
+	void clear()
+	{
+		m_Pairs.clear();
+		m_PairMap.clear();
+		m_Pending.clear();
+		m_SavedPairs = 0;
+		m_SavedEnd = 0;
+		m_Covered = 0;
+	}
+
+	void InsertRecord(const String& srcAddress, const String& dstAddress, long long offset, int size)
+	{
+		String key = srcAddress + ":" + dstAddress;
+		int* pair = m_PairMap.search(key);
+
+		if(!pair)
+		{
+			m_Pairs.InsertBack(PairRecords{srcAddress, dstAddress, Array<Record>()});
+			pair = m_PairMap.insert({key, m_Pairs.size() - 1});
+		}
+
+		m_Pairs[*pair].records.InsertBack(Record{offset, size});
+		m_Pending.InsertBack(Entry{offset, size, *pair});
+		m_Covered = offset + size;
+	}
+
+	void IndexLog(PathLogReader& reader)
+	{
+		// indexes the records of the log past the indexed part
+
+		PathRecord record;
+		reader.seek(m_Covered);
+
+		while(reader.ReadRecord(record))
+			InsertRecord(record.srcAddress, record.dstAddress, record.offset, record.size);
+	}
+
+	bool MatchesLog(PathLogReader& reader) const
+	{
+		// the indexed part must end on a record of the log
+
+		return m_Covered <= reader.size() && reader.IsRecordEnd(m_Covered);
+	}
+
+	// index file implementation
+
+	bool LoadIndex()
+	{
+		MappedFile file;
+
+		if(!file.open(m_IndexPath.data()) || file.size() < (long long)sizeof(Header))
+			return false;
+
+		Header header;
+		std::memcpy(&header, file.data(), sizeof(Header));
+
+		if(std::memcmp(header.magic, IndexMagic(), sizeof(header.magic)) != 0 || header.version != indexVersion)
+			return false;
+
+		const char* data = file.data() + sizeof(Header);
+		const char* end = file.data() + file.size();
+
+		while(data < end)
+		{
+			unsigned long long pair = 0, gap = 0, size = 0;
+
+			if(!PathLog::ReadVarint(data, end, pair))
+				return false;
+
+			if(pair == (unsigned long long)m_Pairs.size())
+			{
+				String names[2];
+
+				for(String& name : names)
+				{
+					unsigned long long length = 0;
+
+					if(!PathLog::ReadVarint(data, end, length) || length > (unsigned long long)(end - data))
+						return false;
+
+					name.append(data, int(length));
+					data += length;
+				}
+
+				m_Pairs.InsertBack(PairRecords{names[0], names[1], Array<Record>()});
+				m_PairMap.insert({names[0] + ":" + names[1], m_Pairs.size() - 1});
+			}
+
+			if(!PathLog::ReadVarint(data, end, gap) || !PathLog::ReadVarint(data, end, size))
+				return false;
+
+			if(pair >= (unsigned long long)m_Pairs.size() || size == 0 || size > 0x7FFFFFFFull)
+				return false;
+
+			Record record;
+			record.offset = m_Covered + (long long)gap;
+			record.size = int(size);
+			m_Pairs[int(pair)].records.InsertBack(record);
+			m_Covered = record.offset + record.size;
+		}
+
+		m_SavedPairs = m_Pairs.size();
+		m_SavedEnd = m_Covered;
+		return true;
+	}
+
+	void RewriteHeader()
+	{
+		Header header{};
+		std::memcpy(header.magic, IndexMagic(), sizeof(header.magic));
+		header.version = indexVersion;
+
+		std::ofstream fout(m_IndexPath.data(), std::ios::binary | std::ios::trunc);
+		fout.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	}
+
+	void SaveIndex()
+	{
+		// appends the pending entries, each new pair is named at its first entry
+
+		if(m_Pending.empty())
+			return;
+
+		std::FILE* file = std::fopen(m_IndexPath.data(), "ab");
+
+		if(!file)
+			return;
+
+		String buffer;
+
+		for(int index = 0; index < m_Pending.size(); index++)
+		{
+			const Entry& entry = m_Pending[index];
+			PathLog::WriteVarint(buffer, entry.pair);
+
+			if(entry.pair == m_SavedPairs)
+			{
+				const PairRecords& pair = m_Pairs[entry.pair];
+
+				for(const String* name : {&pair.srcAddress, &pair.dstAddress})
+				{
+					PathLog::WriteVarint(buffer, name->size());
+					buffer += *name;
+				}
+
+				m_SavedPairs++;
+			}
+
+			PathLog::WriteVarint(buffer, entry.offset - m_SavedEnd);
+			PathLog::WriteVarint(buffer, entry.size);
+			m_SavedEnd = entry.offset + entry.size;
+		}
+
+		std::fwrite(buffer.data(), 1, buffer.size(), file);
+		std::fclose(file);
+		m_Pending.clear();
+	}
+};
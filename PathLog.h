@@ -0,0 +1,695 @@
+#pragma once
+#include "util.h"
+#include "Array.h"
+#include "String.h"
+#include "CsvReader.h"
+#include "LogWriter.h"
+#include "Trace.h"
+
+// place of a record in a path log
+
+struct PathLogSpan
+{
+	long long offset = 0;
+	int size = 0; // bytes of the record, with the newline of a text line
+};
+
+// decoded record of a path log
+
+struct PathRecord
+{
+	long long offset = 0;
+	int size = 0;
+	String line; // text form, ID:SRC:...:DST
+	String srcAddress;
+	String dstAddress;
+};
+
+class PathLog
+{
+	// the binary path log is a header followed by blocks of at most blockSize bytes. a block starts with the
+	// checksum and size of its records and ends with them, so the blocks are found by walking their headers.
+	// a path record is the varint hop count, the zigzag varint message ID and the device of every hop as the
+	// zigzag varint difference to the one before. devices are numbered within each block, the first use of a
+	// device in a block follows a record naming it, which is a hop count of 0, the varint length and the name.
+
+public:
+
+	// types
+
+	struct Header
+	{
+		char magic[8];
+		int version;
+		int blockSize;
+	};
+
+	struct BlockHeader
+	{
+		unsigned checksum; // crc-32 of the records
+		int size; // bytes of the records
+	};
+
+	// constants
+
+	static constexpr int logVersion = 2;
+	static constexpr int blockSize = 1 << 14; // largest block, with its header
+
+	static const char* LogMagic()
+	{ return "NSIMPLOG"; }
+
+	// format
+
+	static bool IsBinaryName(const String& filepath)
+	{ return filepath.size() >= 5 && filepath.substr(filepath.size() - 4) == ".bin"; }
+
+	// blocks
+
+	static long long NextBlock(long long offset, const BlockHeader& header, int maxBlockSize)
+	{
+		// the block following the one at offset. a size out of range still steps past the header, so that a walk
+		// over a damaged log ends.
+
+		return offset + (long long)sizeof(BlockHeader) + Min(Max(header.size, 0), maxBlockSize - (int)sizeof(BlockHeader));
+	}
+
+	// varints
+
+	static void WriteVarint(String& out, unsigned long long value)
+	{
+		// seven bits per byte, low bits first, the high bit marks that more follow
+
+		while(value >= 0x80)
+		{
+			out += char((value & 0x7F) | 0x80);
+			value >>= 7;
+		}
+
+		out += char(value);
+	}
+
+	static bool ReadVarint(const char*& data, const char* end, unsigned long long& value)
+	{
+		value = 0;
+
+		for(int shift = 0; data < end && shift < 64; shift += 7)
+		{
+			unsigned char byte = (unsigned char)*data++;
+			value |= (unsigned long long)(byte & 0x7F) << shift;
+
+			if(!(byte & 0x80))
+				return true;
+		}
+
+		return false;
+	}
+
+	static unsigned long long ZigZag(long long value)
+	{ return ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63); }
+
+	static long long UnZigZag(unsigned long long value)
+	{ return (long long)(value >> 1) ^ -(long long)(value & 1); }
+};
+
+class PathLogEncoder
+{
+	// packs delivered paths into the blocks of a binary path log. the writer gets a block once it is full or
+	// sealed, so the records of a block become visible together.
+
+private:
+
+	// members
+
+	LogWriter* m_Writer = nullptr;
+	String m_Payload; // records of the open block
+	String m_Record;
+	long long m_BlockOffset = 0;
+	Array<int> m_BlockIDs; // number of each device in the open block, -1 if not named in it yet
+	Array<int> m_Named; // devices named in the open block
+
+public:
+
+	// constructors
+
+	PathLogEncoder() = default;
+
+	PathLogEncoder(const PathLogEncoder&) = delete;
+	PathLogEncoder& operator=(const PathLogEncoder&) = delete;
+
+	// open and close
+
+	void open(LogWriter& writer)
+	{
+		// a new log gets its header. a block cut off by a crash is completed with zeros, so that the blocks
+		// written after it are found, its checksum fails and readers skip it.
+
+		close();
+		m_Writer = &writer;
+		long long size = writer.size();
+
+		if(size == 0)
+		{
+			PathLog::Header header{};
+			std::memcpy(header.magic, PathLog::LogMagic(), sizeof(header.magic));
+			header.version = PathLog::logVersion;
+			header.blockSize = PathLog::blockSize;
+
+			String bytes;
+			bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+			writer.push(std::move(bytes));
+		}
+
+		else
+		{
+			std::ifstream file(writer.GetPath().data(), std::ios::binary);
+			long long end = sizeof(PathLog::Header);
+
+			while(end < size)
+			{
+				PathLog::BlockHeader header{};
+				file.seekg(end);
+				file.read(reinterpret_cast<char*>(&header), Min(size - end, (long long)sizeof(header)));
+				end = PathLog::NextBlock(end, header, PathLog::blockSize);
+			}
+
+			if(end > size)
+				writer.push(String('\0', int(end - size)));
+		}
+
+		m_BlockOffset = writer.size();
+		m_Payload.reserve(PathLog::blockSize);
+	}
+
+	void close()
+	{
+		seal();
+		m_Writer = nullptr;
+	}
+
+	bool IsOpen() const
+	{ return m_Writer != nullptr; }
+
+	// write
+
+	template<typename NameFunc>
+	PathLogSpan append(int ID, const Trace& trace, const NameFunc& name)
+	{
+		// name(deviceID) gives the address of a device. a record that does not fit goes to the next block,
+		// where its devices are named again.
+
+		constexpr int capacity = PathLog::blockSize - sizeof(PathLog::BlockHeader);
+		int pathStart = EncodeRecord(ID, trace, name);
+
+		if(m_Payload.size() + m_Record.size() > capacity)
+		{
+			seal();
+			pathStart = EncodeRecord(ID, trace, name);
+			ErrorAbort(m_Record.size() > capacity, "PathLogEncoder::append() : path does not fit in a block");
+		}
+
+		PathLogSpan span;
+		span.offset = m_BlockOffset + (long long)sizeof(PathLog::BlockHeader) + m_Payload.size() + pathStart;
+		span.size = m_Record.size() - pathStart;
+		m_Payload += m_Record;
+		return span;
+	}
+
+	void seal()
+	{
+		// hands the open block to the writer, it takes only the bytes of its records
+
+		if(m_Payload.empty())
+			return;
+
+		PathLog::BlockHeader header;
+		header.checksum = Crc32(m_Payload.data(), m_Payload.size());
+		header.size = m_Payload.size();
+
+		String block;
+		block.reserve(sizeof(header) + m_Payload.size());
+		block.append(reinterpret_cast<const char*>(&header), sizeof(header));
+		block += m_Payload;
+		m_Writer->push(std::move(block));
+
+		m_BlockOffset += sizeof(header) + m_Payload.size();
+		m_Payload.clear();
+
+		for(int index = 0; index < m_Named.size(); index++)
+			m_BlockIDs[m_Named[index]] = -1;
+
+		m_Named.clear();
+	}
+
+private:
+
+	// encoding implementation
+
+	template<typename NameFunc>
+	int EncodeRecord(int ID, const Trace& trace, const NameFunc& name)
+	{
+		// fills m_Record with the names of new devices and the path, returns where the path starts.
+		// a record moved to the next block is encoded again, sealing forgets the devices named here.
+
+		m_Record.clear();
+
+		for(int index = 0; index < trace.size(); index++)
+		{
+			int deviceID = trace[index].deviceID;
+
+			if(deviceID >= m_BlockIDs.size())
+				m_BlockIDs.resize(deviceID + 1, -1);
+
+			if(m_BlockIDs[deviceID] == -1)
+			{
+				const String& address = name(deviceID);
+				m_BlockIDs[deviceID] = m_Named.size();
+				m_Named.InsertBack(deviceID);
+
+				PathLog::WriteVarint(m_Record, 0);
+				PathLog::WriteVarint(m_Record, address.size());
+				m_Record += address;
+			}
+		}
+
+		int pathStart = m_Record.size();
+		long long previous = 0;
+
+		PathLog::WriteVarint(m_Record, trace.size());
+		PathLog::WriteVarint(m_Record, PathLog::ZigZag(ID));
+
+		for(int index = 0; index < trace.size(); index++)
+		{
+			long long blockID = m_BlockIDs[trace[index].deviceID];
+			PathLog::WriteVarint(m_Record, PathLog::ZigZag(blockID - previous));
+			previous = blockID;
+		}
+
+		return pathStart;
+	}
+};
+
+class PathLogReader
+{
+	// reads the path records of a text or binary log in order, or a single record by its place.
+	// a text line with fewer than a message ID and two devices is skipped, as is a last line without its
+	// newline, which the writer has not finished. a binary block whose checksum fails, such as one cut off by
+	// a crash, is skipped whole.
+
+private:
+
+	// members
+
+	String m_Path;
+	bool m_Binary = false;
+	std::ifstream m_File;
+	long long m_FileSize = 0;
+
+	// text log
+
+	CsvReader m_Lines;
+	long long m_Complete = 0; // end of the last complete line
+	Array<Token> m_Fields;
+
+	// binary log
+
+	bool m_ValidHeader = false;
+	int m_BlockSize = PathLog::blockSize;
+	Array<long long> m_Blocks; // starts of the blocks walked, then the end of the walk
+	String m_Block;
+	long long m_BlockOffset = -1; // of the decoded block, -1 before the first
+	long long m_NextBlock = sizeof(PathLog::Header); // read once the decoded block is done
+	Array<PathRecord> m_Records; // of the decoded block
+	int m_Next = 0;
+
+public:
+
+	// constructors
+
+	explicit PathLogReader(const String& filepath)
+		: m_Path(filepath), m_Binary(PathLog::IsBinaryName(filepath)), m_File(filepath.data(), std::ios::binary),
+		m_Lines(filepath, m_Binary ? 1 : CsvReader::defaultBlockSize)
+	{
+		m_File.seekg(0, std::ios::end);
+		m_FileSize = m_File ? (long long)m_File.tellg() : 0;
+
+		if(m_Binary)
+			ReadHeader();
+
+		else if(m_FileSize > 0)
+		{
+			m_File.seekg(m_FileSize - 1);
+			m_Complete = (m_File.get() == '\n') ? m_FileSize : m_FileSize - 1;
+		}
+	}
+
+	PathLogReader(const PathLogReader&) = delete;
+	PathLogReader& operator=(const PathLogReader&) = delete;
+
+	// access
+
+	bool IsOpen() const
+	{ return m_File.is_open(); }
+
+	bool IsBinary() const
+	{ return m_Binary; }
+
+	long long size() const
+	{ return m_FileSize; }
+
+	// position
+
+	void seek(long long offset)
+	{
+		// the next record read is the first one starting at or after offset
+
+		if(!m_Binary)
+		{
+			m_Lines.seek(offset);
+			return;
+		}
+
+		m_Records.clear();
+		m_Next = 0;
+		m_BlockOffset = -1;
+		m_NextBlock = sizeof(PathLog::Header);
+
+		if(offset >= (long long)sizeof(PathLog::Header))
+		{
+			long long blockOffset = BlockOf(offset);
+
+			if(blockOffset == -1)
+			{
+				m_NextBlock = m_Blocks.empty() ? m_FileSize : m_Blocks.back();
+				return;
+			}
+
+			LoadBlock(blockOffset);
+
+			while(m_Next < m_Records.size() && m_Records[m_Next].offset < offset)
+				m_Next++;
+		}
+	}
+
+	bool IsRecordEnd(long long offset)
+	{
+		// whether a record of the log ends at offset, so that the log can be read on from there
+
+		if(offset == 0)
+			return true;
+
+		if(!m_Binary)
+		{
+			m_File.clear();
+			m_File.seekg(offset - 1);
+			return m_File.get() == '\n';
+		}
+
+		if(offset <= (long long)sizeof(PathLog::Header))
+			return false;
+
+		long long blockOffset = BlockOf(offset - 1);
+
+		if(blockOffset == -1 || !LoadBlock(blockOffset))
+			return false;
+
+		for(int index = 0; index < m_Records.size(); index++)
+			if(m_Records[index].offset + m_Records[index].size == offset)
+				return true;
+
+		return false;
+	}
+
+	// read
+
+	bool ReadRecord(PathRecord& record)
+	{
+		return m_Binary ? ReadBinaryRecord(record) : ReadTextRecord(record);
+	}
+
+	bool ReadRecordAt(const PathLogSpan& span, String& line)
+	{
+		// text form of the record at span, false if it is not in the log yet
+
+		if(!m_Binary)
+		{
+			if(span.offset + span.size > m_FileSize)
+				return false;
+
+			line = String(span.size);
+			m_File.clear();
+			m_File.seekg(span.offset);
+
+			if(!m_File.read(line.data(), span.size))
+				return false;
+
+			while(!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+				line.RemoveBack();
+
+			return true;
+		}
+
+		long long blockOffset = BlockOf(span.offset);
+
+		if(blockOffset == -1 || (blockOffset != m_BlockOffset && !LoadBlock(blockOffset)))
+			return false;
+
+		// records of a block are in offset order
+
+		int low = 0, high = m_Records.size() - 1;
+
+		while(low <= high)
+		{
+			int mid = (low + high) / 2;
+
+			if(m_Records[mid].offset == span.offset)
+			{
+				line = m_Records[mid].line;
+				return true;
+			}
+
+			if(m_Records[mid].offset < span.offset)
+				low = mid + 1;
+			else
+				high = mid - 1;
+		}
+
+		return false;
+	}
+
+private:
+
+	// text implementation
+
+	bool ReadTextRecord(PathRecord& record)
+	{
+		Token line;
+
+		while(true)
+		{
+			long long offset = m_Lines.tell();
+
+			if(!m_Lines.ReadLine(line) || m_Lines.tell() > m_Complete)
+				return false;
+
+			line.split(':', m_Fields);
+
+			if(m_Fields.size() >= 3)
+			{
+				record.offset = offset;
+				record.size = int(m_Lines.tell() - offset);
+				record.line = line.str();
+				record.srcAddress = m_Fields[1].str();
+				record.dstAddress = m_Fields.back().str();
+				return true;
+			}
+		}
+	}
+
+	// binary implementation
+
+	void ReadHeader()
+	{
+		PathLog::Header header{};
+
+		if(m_FileSize < (long long)sizeof(header))
+			return;
+
+		m_File.seekg(0);
+		m_File.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+		m_ValidHeader =
+			m_File &&
+			std::memcmp(header.magic, PathLog::LogMagic(), sizeof(header.magic)) == 0 &&
+			header.version == PathLog::logVersion &&
+			header.blockSize > (int)sizeof(PathLog::BlockHeader);
+
+		if(m_ValidHeader)
+		{
+			m_BlockSize = header.blockSize;
+			m_Blocks.InsertBack(sizeof(header));
+		}
+	}
+
+	long long BlockOf(long long offset)
+	{
+		// start of the block holding offset, -1 past the last whole block. the block headers are walked once,
+		// as far as the offsets asked for.
+
+		if(!m_ValidHeader || offset < m_Blocks.front())
+			return -1;
+
+		while(m_Blocks.back() <= offset)
+		{
+			PathLog::BlockHeader header;
+
+			if(!ReadBlockHeader(m_Blocks.back(), header))
+				return -1;
+
+			long long end = PathLog::NextBlock(m_Blocks.back(), header, m_BlockSize);
+
+			if(end > m_FileSize)
+				return -1;
+
+			m_Blocks.InsertBack(end);
+		}
+
+		// the last start at or before offset
+
+		int low = 0, high = m_Blocks.size() - 2;
+
+		while(low < high)
+		{
+			int mid = (low + high + 1) / 2;
+
+			if(m_Blocks[mid] <= offset)
+				low = mid;
+			else
+				high = mid - 1;
+		}
+
+		return m_Blocks[low];
+	}
+
+	bool ReadBlockHeader(long long offset, PathLog::BlockHeader& header)
+	{
+		if(offset + (long long)sizeof(header) > m_FileSize)
+			return false;
+
+		m_File.clear();
+		m_File.seekg(offset);
+		return (bool)m_File.read(reinterpret_cast<char*>(&header), sizeof(header));
+	}
+
+	bool ReadBinaryRecord(PathRecord& record)
+	{
+		while(m_Next == m_Records.size())
+			if(!LoadBlock(m_NextBlock))
+				return false;
+
+
+		record = m_Records[m_Next++];
+		return true;
+	}
+
+	bool LoadBlock(long long offset)
+	{
+		// decodes the block at offset, false past the end of the log or for a block not wholly written yet.
+		// a block failing its checksum has no records.
+
+		m_Records.clear();
+		m_Next = 0;
+
+		PathLog::BlockHeader header;
+
+		if(!m_ValidHeader || !ReadBlockHeader(offset, header))
+			return false;
+
+		long long end = PathLog::NextBlock(offset, header, m_BlockSize);
+
+		if(end > m_FileSize)
+			return false;
+
+		m_BlockOffset = offset;
+		m_NextBlock = end;
+		int count = int(end - offset) - (int)sizeof(header);
+
+		if(header.size <= 0 || header.size != count)
+			return true;
+
+		if(m_Block.size() < count)
+			m_Block = String(m_BlockSize);
+
+		if(!m_File.read(m_Block.data(), count) || Crc32(m_Block.data(), count) != header.checksum)
+			return true;
+
+		DecodeBlock(m_Block.data(), count, offset + (long long)sizeof(header));
+		return true;
+	}
+
+	void DecodeBlock(const char* payload, int size, long long payloadOffset)
+	{
+		// stops at the first malformed record, the checksum matched so it can only come from another writer
+
+		Array<String> devices;
+		const char* data = payload;
+		const char* end = payload + size;
+
+		while(data < end)
+		{
+			const char* start = data;
+			unsigned long long count = 0;
+
+			if(!PathLog::ReadVarint(data, end, count))
+				return;
+
+			if(count == 0)
+			{
+				unsigned long long length = 0;
+
+				if(!PathLog::ReadVarint(data, end, length) || length > (unsigned long long)(end - data))
+					return;
+
+				String address;
+				address.append(data, int(length));
+				devices.InsertBack(std::move(address));
+				data += length;
+				continue;
+			}
+
+			unsigned long long zigzag = 0;
+
+			if(!PathLog::ReadVarint(data, end, zigzag))
+				return;
+
+			PathRecord record;
+			record.offset = payloadOffset + (start - payload);
+			record.line = NumToStr(PathLog::UnZigZag(zigzag));
+			long long deviceID = 0;
+
+			for(unsigned long long hop = 0; hop < count; hop++)
+			{
+				if(!PathLog::ReadVarint(data, end, zigzag))
+					return;
+
+				deviceID += PathLog::UnZigZag(zigzag);
+
+				if(deviceID < 0 || deviceID >= devices.size())
+					return;
+
+				const String& address = devices[int(deviceID)];
+				record.line += ':';
+				record.line += address;
+
+				if(hop == 0)
+					record.srcAddress = address;
+
+				record.dstAddress = address;
+			}
+
+			record.size = int(data - start);
+
+			if(count >= 2)
+				m_Records.InsertBack(std::move(record));
+		}
+	}
+};
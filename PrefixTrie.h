@@ -0,0 +1,254 @@
+#pragma once
+#include "util.h"
+#include "Array.h"
+#include "String.h"
+#include "HashTable.h"
+
+// addresses
+
+String FormatNetAddress(unsigned address, int prefixLength = -1)
+{
+	// dotted quad, followed by /length when a prefix length is given
+
+	String result;
+
+	for(int shift = 24; shift >= 0; shift -= 8)
+	{
+		int octet = (address >> shift) & 255;
+		char digits[4]{};
+		int count = 0;
+
+		do
+		{
+			digits[count++] = char('0' + (octet % 10));
+			octet /= 10;
+
+		} while(octet);
+
+		while(count)
+			result.InsertBack(digits[--count]);
+
+		if(shift)
+			result.InsertBack('.');
+	}
+
+	if(prefixLength >= 0)
+	{
+		result.InsertBack('/');
+
+		if(prefixLength >= 10)
+			result.InsertBack(char('0' + prefixLength / 10));
+
+		result.InsertBack(char('0' + prefixLength % 10));
+	}
+
+	return result;
+}
+
+template<typename Value>
+class PrefixTrie
+{
+	// multibit trie over 32-bit addresses doing longest prefix match.
+	// each level consumes 8 bits, so a lookup reads at most 4 nodes. a prefix whose length
+	// is not a multiple of 8 is expanded over all entries of its last level that it covers,
+	// and an entry keeps the longest prefix written to it.
+
+public:
+
+	// types
+
+	struct Route
+	{
+		unsigned prefix = 0;
+		int length = 0;
+		Value value = Value();
+	};
+
+private:
+
+	// types
+
+	struct Entry
+	{
+		int child = -1; // node index of next level
+		int length = -1; // length of stored prefix, -1 if none
+		Value value = Value();
+	};
+
+	struct Node
+	{
+		Entry entries[256];
+	};
+
+	// members
+
+	Array<Node> m_Nodes = Array<Node>(1); // node 0 is the root
+	Array<Route> m_Routes; // inserted prefixes, used to rebuild after removal
+	HashTable<long long, int> m_RouteIndices; // index in m_Routes by prefix and length
+
+	// indexing
+
+	static int octet(unsigned address, int level)
+	{ return (address >> (24 - (8 * level))) & 255; }
+
+	static unsigned mask(int length)
+	{ return length == 0 ? 0 : (0xffffffffu << (32 - length)); }
+
+	static long long RouteKey(unsigned prefix, int length)
+	{ return ((long long)prefix << 6) | length; }
+
+public:
+
+	// empty state
+
+	bool empty() const
+	{ return m_Routes.empty(); }
+
+	void clear()
+	{
+		m_Nodes = Array<Node>(1);
+		m_Routes.clear();
+		m_RouteIndices.clear();
+	}
+
+	// access
+
+	int size() const
+	{ return m_Routes.size(); }
+
+	const Array<Route>& GetRoutes() const
+	{ return m_Routes; }
+
+	// search
+
+	const Value* search(unsigned address) const
+	{
+		// returns value of longest prefix covering address, nullptr if none does
+
+		const Entry* best = nullptr;
+		int nodeIndex = 0;
+
+		for(int level = 0; level < 4 && nodeIndex != -1; level++)
+		{
+			const Entry& entry = m_Nodes[nodeIndex].entries[octet(address, level)];
+
+			if(entry.length != -1)
+				best = &entry;
+
+			nodeIndex = entry.child;
+		}
+
+		return best ? &best->value : nullptr;
+	}
+
+	const Value* find(unsigned prefix, int length) const
+	{
+		// exact prefix search
+
+		int index = FindRoute(prefix & mask(length), length);
+		return (index == -1) ? nullptr : &m_Routes[index].value;
+	}
+
+	// insert
+
+	void insert(unsigned prefix, int length, const Value& value)
+	{
+		// inserts prefix, or changes its value if already present
+
+		ErrorAbort(!InRange(length, 0, 32), "PrefixTrie::insert() : invalid prefix length");
+		prefix &= mask(length);
+
+		int index = FindRoute(prefix, length);
+
+		if(index == -1)
+		{
+			m_RouteIndices.insert({RouteKey(prefix, length), m_Routes.size()});
+			m_Routes.InsertBack({prefix, length, value});
+		}
+		else
+			m_Routes[index].value = value;
+
+		expand({prefix, length, value});
+	}
+
+	// remove
+
+	bool remove(unsigned prefix, int length)
+	{
+		prefix &= mask(length);
+		int index = FindRoute(prefix, length);
+
+		if(index == -1)
+			return false;
+
+		// last route fills the hole
+
+		m_RouteIndices.remove(RouteKey(prefix, length));
+
+		if(index != m_Routes.size() - 1)
+		{
+			m_Routes[index] = m_Routes.back();
+			*m_RouteIndices.search(RouteKey(m_Routes[index].prefix, m_Routes[index].length)) = index;
+		}
+
+		m_Routes.RemoveBack();
+
+		// expanded entries may hide shorter prefixes, so the nodes are rebuilt from the remaining routes
+
+		m_Nodes = Array<Node>(1);
+
+		for(int routeIndex = 0; routeIndex < m_Routes.size(); routeIndex++)
+			expand(m_Routes[routeIndex]);
+
+		return true;
+	}
+
+private:
+
+	// implementation
+
+	int FindRoute(unsigned prefix, int length) const
+	{
+		const int* index = m_RouteIndices.search(RouteKey(prefix, length));
+		return index ? *index : -1;
+	}
+
+	void expand(const Route& route)
+	{
+		// walk down to the level holding the last (partial) octet of the prefix
+
+		int nodeIndex = 0;
+		int level = 0;
+
+		for(; route.length > 8 * (level + 1); level++)
+		{
+			int child = m_Nodes[nodeIndex].entries[octet(route.prefix, level)].child;
+
+			if(child == -1)
+			{
+				child = m_Nodes.size();
+				m_Nodes.InsertBack(Node());
+				m_Nodes[nodeIndex].entries[octet(route.prefix, level)].child = child;
+			}
+
+			nodeIndex = child;
+		}
+
+		// write every entry covered by the remaining bits
+
+		int bits = route.length - (8 * level);
+		int first = octet(route.prefix, level);
+		int count = 1 << (8 - bits);
+
+		for(int entryIndex = first; entryIndex < first + count; entryIndex++)
+		{
+			Entry& entry = m_Nodes[nodeIndex].entries[entryIndex];
+
+			if(entry.length <= route.length)
+			{
+				entry.length = route.length;
+				entry.value = route.value;
+			}
+		}
+	}
+};
@@ -1,10 +1,7 @@
-
 #pragma once
 #include "util.h"
 #include "Array.h"
 
-// TODO: add build-heap construction
-
 template<typename ComparatorType>
 class PriorityQueue
 {
@@ -35,6 +32,21 @@ private:
 
 public:
 
+	// constructors
+
+	PriorityQueue() = default;
+
+	explicit PriorityQueue(const Array<Type>& data)
+	{
+		// build-heap, sifts down every internal node from the bottom up in O(n)
+
+		for(int index = 0; index < data.size(); index++)
+			m_Data.InsertBack(data[index]);
+
+		for(int index = parent(m_Data.size() - 1); index >= root(); index--)
+			SiftDown(index);
+	}
+
 	// empty state
 
 	bool empty() const
@@ -59,8 +71,43 @@ public:
 	void enqueue(const Type& data)
 	{
 		m_Data.InsertBack(data);
+		SiftUp(m_Data.size() - 1);
+	}
+
+	void enqueue(Type&& data)
+	{
+		m_Data.InsertBack(std::move(data));
+		SiftUp(m_Data.size() - 1);
+	}
+
+	void dequeue()
+	{
+		ErrorAbort(empty(), "PriorityQueue::dequeue() : queue is empty");
 
-		for(int index = m_Data.size() - 1; index > root();)
+		if(size() > 1)
+			m_Data[root()] = std::move(m_Data.back());
+
+		m_Data.RemoveBack();
+		SiftDown(root());
+	}
+
+	Type extract()
+	{
+		// dequeues and returns the front element, moving it out instead of copying
+
+		ErrorAbort(empty(), "PriorityQueue::extract() : queue is empty");
+		Type data = std::move(m_Data[root()]);
+		dequeue();
+		return data;
+	}
+
+private:
+
+	// sift implementation
+
+	void SiftUp(int index)
+	{
+		while(index > root())
 		{
 			int parentIndex = parent(index);
 
@@ -73,21 +120,20 @@ public:
 		}
 	}
 
-	void dequeue()
+	void SiftDown(int index)
 	{
-		ErrorAbort(empty(), "PriorityQueue::dequeue() : queue is empty");
-		m_Data[root()] = m_Data.back();
-		m_Data.RemoveBack();
-
-		for(int index = root(); index < m_Data.size();)
+		while(index < m_Data.size())
 		{
 			int leftIndex = LeftChild(index);
 			int rightIndex = RightChild(index);
 
-			if(!(leftIndex < m_Data.size() && rightIndex < m_Data.size()))
+			if(!(leftIndex < m_Data.size()))
 				break;
 
-			int nextIndex = m_Comparator.compare(m_Data[leftIndex], m_Data[rightIndex]) ? leftIndex : rightIndex;
+			// a node may only have a left child at the bottom level
+
+			bool hasRight = rightIndex < m_Data.size();
+			int nextIndex = (!hasRight || m_Comparator.compare(m_Data[leftIndex], m_Data[rightIndex])) ? leftIndex : rightIndex;
 
 			if(!m_Comparator.compare(m_Data[index], m_Data[nextIndex]))
 			{
@@ -98,3 +144,198 @@ public:
 		}
 	}
 };
+
+template<typename ComparatorType, int Arity = 4>
+class IndexedPriorityQueue
+{
+	// queues the items [0, capacity) by key, tracking the heap position of every item
+	// so that keys can be decreased in place and each item is queued at most once.
+
+private:
+
+	// types
+
+	using Key = typename ComparatorType::ValueType;
+
+	// members
+
+	Array<int> m_Heap; // items in heap order
+	Array<int> m_Positions; // heap position of each item, -1 if not queued
+	Array<Key> m_Keys; // key of each item
+	Array<bool> m_Settled; // item has been dequeued
+	ComparatorType m_Comparator;
+
+	// indexing
+
+	static int parent(int index)
+	{ return (index - 1) / Arity; }
+
+	static int FirstChild(int index)
+	{ return (index * Arity) + 1; }
+
+public:
+
+	// constructors
+
+	explicit IndexedPriorityQueue(int capacity)
+		: m_Positions(capacity, -1), m_Keys(capacity), m_Settled(capacity, false)
+	{}
+
+	// empty state
+
+	bool empty() const
+	{ return m_Heap.empty(); }
+
+	void clear()
+	{
+		for(int index = 0; index < m_Heap.size(); index++)
+			m_Positions[m_Heap[index]] = -1;
+
+		m_Heap.clear();
+		m_Settled.fill(false);
+	}
+
+	// access
+
+	int size() const
+	{ return m_Heap.size(); }
+
+	int capacity() const
+	{ return m_Positions.size(); }
+
+	bool contains(int item) const
+	{ return m_Positions[item] != -1; }
+
+	bool settled(int item) const
+	{ return m_Settled[item]; }
+
+	const Key& key(int item) const
+	{ return m_Keys[item]; }
+
+	int front() const
+	{
+		ErrorAbort(empty(), "IndexedPriorityQueue::front() : queue is empty");
+		return m_Heap.front();
+	}
+
+	const Key& FrontKey() const
+	{ return m_Keys[front()]; }
+
+	// enqueue and dequeue
+
+	void enqueue(int item, const Key& key)
+	{
+		ErrorAbort(!InRange(item, 0, capacity() - 1), "IndexedPriorityQueue::enqueue() : item out of bounds");
+		ErrorAbort(contains(item) || settled(item), "IndexedPriorityQueue::enqueue() : item already queued");
+
+		m_Keys[item] = key;
+		m_Positions[item] = m_Heap.size();
+		m_Heap.InsertBack(item);
+		SiftUp(m_Heap.size() - 1);
+	}
+
+	void DecreaseKey(int item, const Key& key)
+	{
+		ErrorAbort(!contains(item), "IndexedPriorityQueue::DecreaseKey() : item not queued");
+		ErrorAbort(m_Comparator.compare(m_Keys[item], key), "IndexedPriorityQueue::DecreaseKey() : key is not decreased");
+
+		m_Keys[item] = key;
+		SiftUp(m_Positions[item]);
+	}
+
+	void dequeue()
+	{
+		ErrorAbort(empty(), "IndexedPriorityQueue::dequeue() : queue is empty");
+
+		int item = m_Heap.front();
+		m_Positions[item] = -1;
+		m_Settled[item] = true;
+
+		if(m_Heap.size() > 1)
+		{
+			Place(m_Heap.back(), 0);
+			m_Heap.RemoveBack();
+			SiftDown(0);
+		}
+		else
+			m_Heap.RemoveBack();
+	}
+
+	// build-heap
+
+	void BuildHeap(const Array<int>& items, const Array<Key>& keys)
+	{
+		// queues the given unqueued items with keys[item] in O(n) by sifting down from the bottom up.
+
+		for(int index = 0; index < items.size(); index++)
+		{
+			int item = items[index];
+			ErrorAbort(contains(item) || settled(item), "IndexedPriorityQueue::BuildHeap() : item already queued");
+			m_Keys[item] = keys[item];
+			m_Positions[item] = m_Heap.size();
+			m_Heap.InsertBack(item);
+		}
+
+		if(m_Heap.size() > 1)
+			for(int index = parent(m_Heap.size() - 1); index >= 0; index--)
+				SiftDown(index);
+	}
+
+private:
+
+	// sift implementation
+
+	void Place(int item, int index)
+	{
+		m_Heap[index] = item;
+		m_Positions[item] = index;
+	}
+
+	void SiftUp(int index)
+	{
+		// moves the item up by shifting parents down, placing it once at the end
+
+		int item = m_Heap[index];
+
+		while(index > 0)
+		{
+			int parentIndex = parent(index);
+
+			if(!m_Comparator.compare(m_Keys[item], m_Keys[m_Heap[parentIndex]]))
+				break;
+
+			Place(m_Heap[parentIndex], index);
+			index = parentIndex;
+		}
+
+		Place(item, index);
+	}
+
+	void SiftDown(int index)
+	{
+		int item = m_Heap[index];
+
+		while(true)
+		{
+			int firstChild = FirstChild(index);
+
+			if(firstChild >= m_Heap.size())
+				break;
+
+			int lastChild = Min(firstChild + Arity, m_Heap.size());
+			int bestChild = firstChild;
+
+			for(int child = firstChild + 1; child < lastChild; child++)
+				if(m_Comparator.compare(m_Keys[m_Heap[child]], m_Keys[m_Heap[bestChild]]))
+					bestChild = child;
+
+			if(!m_Comparator.compare(m_Keys[m_Heap[bestChild]], m_Keys[item]))
+				break;
+
+			Place(m_Heap[bestChild], index);
+			index = bestChild;
+		}
+
+		Place(item, index);
+	}
+};
@@ -1,72 +1,180 @@
-
 #pragma once
 #include "util.h"
-#include "List.h"
+#include "Array.h"
 
 template<typename Type>
 class Queue
 {
+	// ring buffer over a power-of-two array, so wrapping an index is a mask.
+	// a growable queue doubles its buffer when full, a fixed-capacity queue never
+	// reallocates and aborts when enqueued while full.
+
 private:
 
 	// members
 
-	List<Type> m_List;
+	Array<Type> m_Buffer;
+	int m_Head = 0; // slot of the front element
+	int m_Size = 0;
+	bool m_Fixed = false;
+
+	// indexing
+
+	int mask() const
+	{ return m_Buffer.size() - 1; }
+
+	int slot(int offset) const
+	{ return (m_Head + offset) & mask(); }
 
 public:
 
+	// constructors
+
+	Queue() = default;
+
+	explicit Queue(int capacity)
+		: m_Buffer(RoundUpCapacity(capacity)), m_Fixed(true)
+	{}
+
 	// empty state
 
 	bool empty() const
-	{ return m_List.empty(); }
+	{ return m_Size == 0; }
+
+	bool full() const
+	{ return m_Size == m_Buffer.size(); }
 
 	void clear()
-	{ m_List.clear(); }
+	{
+		// elements are reset so they let go of what they own, the buffer is kept
+
+		for(int offset = 0; offset < m_Size; offset++)
+			m_Buffer[slot(offset)] = Type();
+
+		m_Head = 0;
+		m_Size = 0;
+	}
 
 	// access
 
 	int size() const
-	{ return m_List.size(); }
+	{ return m_Size; }
+
+	int capacity() const
+	{ return m_Buffer.size(); }
+
+	bool fixed() const
+	{ return m_Fixed; }
 
 	Type& front()
 	{
 		ErrorAbort(empty(), "Queue::front() : queue is empty");
-		return m_List.front();
+		return m_Buffer[m_Head];
 	}
 
 	const Type& front() const
 	{
 		ErrorAbort(empty(), "Queue::front() : queue is empty");
-		return m_List.front();
+		return m_Buffer[m_Head];
 	}
 
 	Type& back()
 	{
 		ErrorAbort(empty(), "Queue::back() : queue is empty");
-		return m_List.back();
+		return m_Buffer[slot(m_Size - 1)];
 	}
 
 	const Type& back() const
 	{
 		ErrorAbort(empty(), "Queue::back() : queue is empty");
-		return m_List.back();
+		return m_Buffer[slot(m_Size - 1)];
 	}
 
 	// enqueue and dequeue
 
 	void enqueue(const Type& data)
-	{ m_List.InsertBack(data); }
+	{
+		Type copy = data; // data may live in the buffer, which growing moves
+		enqueue(std::move(copy));
+	}
+
+	void enqueue(Type&& data)
+	{
+		if(full())
+		{
+			Type temp = std::move(data);
+			grow();
+			m_Buffer[slot(m_Size++)] = std::move(temp);
+		}
+		else
+			m_Buffer[slot(m_Size++)] = std::move(data);
+	}
+
+	template<typename... Args>
+	void emplace(Args&&... args)
+	{ enqueue(Type{std::forward<Args>(args)...}); }
 
 	void dequeue()
 	{
 		ErrorAbort(empty(), "Queue::dequeue() : queue is empty");
-		m_List.RemoveFront();
+		m_Buffer[m_Head] = Type();
+		m_Head = slot(1);
+		m_Size--;
+	}
+
+	Type extract()
+	{
+		// dequeues and returns the front element, moving it out instead of copying
+
+		ErrorAbort(empty(), "Queue::extract() : queue is empty");
+		Type data = std::move(m_Buffer[m_Head]);
+		dequeue();
+		return data;
 	}
 
 	// compare
 
-	friend bool operator==(const Queue<Type>& q1, const Queue<Type>& q2)
-	{ return q1.m_List == q2.m_List; }
+	friend bool operator==(const Queue& q1, const Queue& q2)
+	{
+		if(q1.size() != q2.size())
+			return false;
+
+		for(int offset = 0; offset < q1.size(); offset++)
+			if(!(q1.m_Buffer[q1.slot(offset)] == q2.m_Buffer[q2.slot(offset)]))
+				return false;
 
-	friend bool operator!=(const Queue<Type>& q1, const Queue<Type>& q2)
+		return true;
+	}
+
+	friend bool operator!=(const Queue& q1, const Queue& q2)
 	{ return !(q1 == q2); }
+
+private:
+
+	// growth implementation
+
+	static int RoundUpCapacity(int capacity)
+	{
+		int result = 1;
+
+		while(result < capacity)
+			result *= 2;
+
+		return result;
+	}
+
+	void grow()
+	{
+		ErrorAbort(m_Fixed, "Queue::enqueue() : fixed-capacity queue is full");
+
+		// elements are moved to the front of the new buffer in queue order
+
+		Array<Type> buffer(Max(m_Buffer.size() * 2, 4));
+
+		for(int offset = 0; offset < m_Size; offset++)
+			buffer[offset] = std::move(m_Buffer[slot(offset)]);
+
+		m_Buffer = std::move(buffer);
+		m_Head = 0;
+	}
 };
@@ -1,10 +1,13 @@
 
 #pragma once
 #include "util.h"
+#include <memory>
 #include "String.h"
 #include "List.h"
 #include "PriorityQueue.h"
 #include "SplayTree.h"
+#include "HashTable.h"
+#include "PrefixTrie.h"
 #include "Message.h"
 #include "NetworkDevice.h"
 
@@ -20,6 +23,10 @@ public:
 
 		String destAddress;
 		String nextAddress;
+		int destID = -1; // device ids, only needed by direct and trie tables
+		int nextID = -1;
+		unsigned destPrefix = 0; // destination prefix, only needed by trie tables
+		int prefixLength = -1;
 
 		// compare
 
@@ -30,105 +37,177 @@ public:
 		{ return !(f1 == f2); }
 	};
 
-	using List = List<Field>;
-	using Tree = SplayTree<String, String>;
+	using List = List<Field, PoolAllocator>;
+	using Tree = SplayTree<String, String, PoolAllocator>;
+	using Hash = HashTable<String, String>;
+	using Direct = Array<int>; // next device id indexed by destination id, -1 if no route
+	using Trie = PrefixTrie<int>; // next device id by longest destination prefix
 	using PriorityQueue = PriorityQueue<GreaterEqual<Message>>;
-	enum class TableType {List, Tree};
+	enum class TableType {List, Tree, Hash, Direct, Trie};
 
-private:
-
-	// members
-
-	Router::PriorityQueue m_InQueue;
-	Router::List m_RoutingList;
-	Router::Tree m_RoutingTree;
-
-public:
-
-	// constructors
+	struct Table
+	{
+		// routing tables of a router. a published table is never changed, writers change a copy
+		// and publish it, so lookups need no locks and never see a half-made change.
 
-	explicit Router(const String& address)
-		: NetworkDevice(address)
-	{}
+		// members
 
-	// getters
+		Router::List list;
+		Router::Tree tree;
+		Router::Hash hash;
+		Router::Direct direct;
+		Router::Trie trie;
 
-	const Router::PriorityQueue& GetInQueue() const
-	{ return m_InQueue; }
+		// fields
 
-	const Router::List& GetRoutingList() const
-	{ return m_RoutingList; }
+		void InsertField(const Field& insertionField, TableType tableType)
+		{
+			if(tableType == TableType::List)
+			{
+				// if destination address is already present, change its corresponding next address.
 
-	const Router::Tree& GetRoutingTree() const
-	{ return m_RoutingTree; }
+				for(auto field = list.first(); field.valid(); ++field)
+				{
+					if(field->destAddress == insertionField.destAddress)
+					{
+						field->nextAddress = insertionField.nextAddress;
+						return;
+					}
+				}
 
-	// setters
+				// if not present, add it along with it corresponding next address.
 
-	void SetRoutingList(const Router::List& routingList)
-	{ m_RoutingList = routingList; }
+				list.InsertBack(insertionField);
+				return;
+			}
 
-	void SetRoutingTree(const Router::Tree& routingTree)
-	{ m_RoutingTree = routingTree; }
+			else if(tableType == TableType::Tree)
+			{
+				// same approach as list insertion
 
-	// fields
+				if(auto field = tree.search(insertionField.destAddress))
+				{
+					*field = insertionField.nextAddress;
+					return;
+				}
 
-	void InsertField(const Field& insertionField, TableType tableType)
-	{
-		if(tableType == TableType::List)
-		{
-			// if destination address is already present, change its corresponding next address.
+				tree.insert({insertionField.destAddress, insertionField.nextAddress});
+				return;
+			}
 
-			for(auto field = m_RoutingList.first(); field.valid(); ++field)
+			else if(tableType == TableType::Hash)
 			{
-				if(field->destAddress == insertionField.destAddress)
+				// same approach as list insertion
+
+				if(auto field = hash.search(insertionField.destAddress))
 				{
-					field->nextAddress = insertionField.nextAddress;
+					*field = insertionField.nextAddress;
 					return;
 				}
+
+				hash.insert({insertionField.destAddress, insertionField.nextAddress});
+				return;
 			}
 
-			// if not present, add it along with it corresponding next address.
+			else if(tableType == TableType::Direct)
+			{
+				ErrorAbort(insertionField.destID < 0 || insertionField.nextID < 0, "Router::Table::InsertField() : direct tables need device ids");
 
-			m_RoutingList.InsertBack(insertionField);
-			return;
-		}
+				while(direct.size() <= insertionField.destID)
+					direct.InsertBack(-1);
 
-		else if(tableType == TableType::Tree)
-		{
-			// same approach as list insertion
+				direct[insertionField.destID] = insertionField.nextID;
+				return;
+			}
 
-			if(auto field = m_RoutingTree.search(insertionField.destAddress))
+			else if(tableType == TableType::Trie)
 			{
-				*field = insertionField.nextAddress;
+				ErrorAbort(insertionField.prefixLength < 0 || insertionField.nextID < 0, "Router::Table::InsertField() : trie tables need prefixes and device ids");
+				trie.insert(insertionField.destPrefix, insertionField.prefixLength, insertionField.nextID);
 				return;
 			}
-
-			m_RoutingTree.insert({insertionField.destAddress, insertionField.nextAddress});
-			return;
 		}
-	}
 
-	bool RemoveField(const Field& removalField, TableType tableType)
-	{
-		if(tableType == TableType::List)
+		bool RemoveField(const Field& removalField, TableType tableType)
 		{
-			auto field = m_RoutingList.search(removalField);
+			if(tableType == TableType::List)
+			{
+				auto field = list.search(removalField);
 
-			if(!field.valid())
-				return false;
+				if(!field.valid())
+					return false;
+
+				else
+				{
+					list.remove(field);
+					return true;
+				}
+			}
 
-			else
+			else if(tableType == TableType::Tree)
+				return tree.remove(removalField.destAddress);
+
+			else if(tableType == TableType::Hash)
+				return hash.remove(removalField.destAddress);
+
+			else if(tableType == TableType::Direct)
 			{
-				m_RoutingList.remove(field);
+				int destID = removalField.destID;
+
+				if(!InRange(destID, 0, direct.size() - 1) || direct[destID] == -1)
+					return false;
+
+				direct[destID] = -1;
 				return true;
 			}
+
+			else if(tableType == TableType::Trie)
+				return removalField.prefixLength >= 0 && trie.remove(removalField.destPrefix, removalField.prefixLength);
+
+			else 
+				return false;
 		}
+	};
 
-		else if(tableType == TableType::Tree)
-			return m_RoutingTree.remove(removalField.destAddress);
+	using TablePtr = std::shared_ptr<const Table>;
+
+private:
+
+	// members
+
+	Router::PriorityQueue m_InQueue;
+	Router::TablePtr m_RoutingTable = std::make_shared<const Table>(); // only accessed atomically
+
+public:
+
+	// constructors
+
+	explicit Router(const String& address)
+		: NetworkDevice(address)
+	{}
+
+	// getters
+
+	const Router::PriorityQueue& GetInQueue() const
+	{ return m_InQueue; }
+
+	Router::TablePtr GetRoutingTable() const
+	{ return std::atomic_load(&m_RoutingTable); }
+
+	// setters
+
+	void SetRoutingTable(Router::TablePtr routingTable)
+	{ std::atomic_store(&m_RoutingTable, routingTable); }
+
+	void SetRoutingTable(const Router::Table& routingTable)
+	{ SetRoutingTable(Table(routingTable)); }
 
-		else 
-			return false;
+	void SetRoutingTable(Router::Table&& routingTable)
+	{
+		// published trees are only searched without splaying, so they are balanced first
+
+		routingTable.tree.balance();
+		SetRoutingTable(std::make_shared<const Table>(std::move(routingTable)));
 	}
 
 	// messages
@@ -136,12 +215,14 @@ public:
 	void InsertMessage(const Message& msg) override
 	{ m_InQueue.enqueue(msg); }
 
+	void InsertMessage(Message&& msg) override
+	{ m_InQueue.enqueue(std::move(msg)); }
+
 	bool ReadMessage() override
 	{
 		if(!m_InQueue.empty())
 		{
-			m_OutQueue.enqueue(m_InQueue.front());
-			m_InQueue.dequeue();
+			m_OutQueue.enqueue(m_InQueue.extract());
 			return true;
 		}
 		else return false;
@@ -159,21 +240,52 @@ public:
 
 	// routing decision
 
+	// lookups read the table published when they start and may run on any number of threads
+
 	String RoutingDecision(const String& destAddress, TableType tableType) const
 	{
+		Router::TablePtr table = GetRoutingTable();
+
 		if(tableType == TableType::List)
 		{
-			for(auto field = m_RoutingList.first(); field.valid(); ++field)
+			for(auto field = table->list.first(); field.valid(); ++field)
 				if(field->destAddress == destAddress)
 					return field->nextAddress;
 		}
 
 		else if(tableType == TableType::Tree)
 		{
-			if(auto search = m_RoutingTree.search(destAddress))
+			if(auto search = table->tree.search(destAddress))
+				return *search;
+		}
+
+		else if(tableType == TableType::Hash)
+		{
+			if(auto search = table->hash.search(destAddress))
 				return *search;
 		}
 
 		return {};
 	}
+
+	int RoutingDecision(int destID) const
+	{
+		// direct tables only, returns next device id or -1 if there is no route.
+
+		Router::TablePtr table = GetRoutingTable();
+
+		if(!InRange(destID, 0, table->direct.size() - 1))
+			return -1;
+
+		return table->direct[destID];
+	}
+
+	int PrefixDecision(unsigned destNetAddress) const
+	{
+		// trie tables only, returns next device id of the longest matching prefix or -1 if none matches.
+
+		Router::TablePtr table = GetRoutingTable();
+		const int* search = table->trie.search(destNetAddress);
+		return search ? *search : -1;
+	}
 };
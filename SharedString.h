@@ -0,0 +1,112 @@
+#pragma once
+#include "util.h"
+#include "String.h"
+#include <atomic>
+
+class SharedString
+{
+	// immutable string whose characters are stored once and shared by every copy of the handle.
+	// copies only bump an atomic reference count, so handles may be copied and dropped on any thread.
+
+private:
+
+	// types
+
+	struct Block
+	{
+		std::atomic<int> references{1};
+		const String text;
+
+		explicit Block(const String& text)
+			: text(text)
+		{}
+
+		explicit Block(String&& text)
+			: text(std::move(text))
+		{}
+	};
+
+	// members
+
+	Block* m_Block = nullptr; // nullptr for the empty string
+
+public:
+
+	// constructors and memory management
+
+	SharedString() = default;
+
+	SharedString(const String& str)
+		: m_Block(new Block(str))
+	{}
+
+	SharedString(String&& str)
+		: m_Block(new Block(std::move(str)))
+	{}
+
+	SharedString(const char* str)
+		: m_Block(new Block(String(str)))
+	{}
+
+	SharedString(const SharedString& other)
+		: m_Block(other.m_Block)
+	{
+		if(m_Block)
+			m_Block->references.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	SharedString(SharedString&& other) noexcept
+		: m_Block(other.m_Block)
+	{ other.m_Block = nullptr; }
+
+	SharedString& operator=(SharedString other) noexcept
+	{
+		// copy or move made by the parameter, then swapped in
+
+		Block* block = m_Block;
+		m_Block = other.m_Block;
+		other.m_Block = block;
+		return *this;
+	}
+
+	~SharedString()
+	{
+		if(m_Block && m_Block->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			delete m_Block;
+	}
+
+	// empty state
+
+	bool empty() const
+	{ return size() == 0; }
+
+	// access
+
+	const String& str() const
+	{
+		static const String emptyString;
+		return m_Block ? m_Block->text : emptyString;
+	}
+
+	const char* data() const
+	{ return str().data(); }
+
+	int size() const
+	{ return m_Block ? m_Block->text.size() : 0; }
+
+	int UseCount() const
+	{ return m_Block ? m_Block->references.load(std::memory_order_relaxed) : 0; }
+
+	// compare
+
+	friend bool operator==(const SharedString& s1, const SharedString& s2)
+	{ return s1.m_Block == s2.m_Block || s1.str() == s2.str(); }
+
+	friend bool operator!=(const SharedString& s1, const SharedString& s2)
+	{ return !(s1 == s2); }
+};
+
+// output
+
+std::ostream& operator<<(std::ostream& out, const SharedString& str)
+{ return out << str.str(); }
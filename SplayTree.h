@@ -2,8 +2,11 @@
 #pragma once
 #include "util.h"
 #include "Pair.h"
+#include "Allocator.h"
+#include "Array.h"
+#include <type_traits>
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, template<typename> class Allocator = HeapAllocator>
 class SplayTree
 {
 private:
@@ -21,7 +24,8 @@ private:
 
 	// members
 
-	mutable Node* m_Root = nullptr;
+	Node* m_Root = nullptr;
+	Allocator<Node> m_Allocator;
 
 public:
 
@@ -32,6 +36,10 @@ public:
 	SplayTree(const SplayTree& other)
 	{ CopyImpl(m_Root, other.m_Root); }
 
+	SplayTree(SplayTree&& other) noexcept
+		: m_Root(other.m_Root), m_Allocator(std::move(other.m_Allocator))
+	{ other.m_Root = nullptr; }
+
 	SplayTree& operator=(const SplayTree& other)
 	{
 		if(this != &other)
@@ -43,6 +51,19 @@ public:
 		return *this;
 	}
 
+	SplayTree& operator=(SplayTree&& other) noexcept
+	{
+		if(this != &other)
+		{
+			clear();
+			m_Root = other.m_Root;
+			m_Allocator = std::move(other.m_Allocator);
+			other.m_Root = nullptr;
+		}
+
+		return *this;
+	}
+
 	~SplayTree()
 	{ clear(); }
 
@@ -52,7 +73,15 @@ public:
 	{ return m_Root == nullptr; }
 
 	void clear()
-	{ ClearImpl(m_Root); }
+	{
+		// pooled nodes are released together, and are not even visited if they need no destruction
+
+		if(!(Allocator<Node>::bulkClear && std::is_trivially_destructible<Node>::value))
+			ClearImpl(m_Root);
+
+		m_Allocator.clear();
+		m_Root = nullptr;
+	}
 
 	// search
 
@@ -71,47 +100,32 @@ public:
 
 	const Value* search(const Key& key) const
 	{
-		if(empty())
-			return nullptr;
-
-		m_Root = splay(key, m_Root);
+		// plain descent without splaying, so concurrent readers never change the tree
 
-		if(m_Root->kv.first != key)
-			return nullptr;
+		const Node* currentNode = m_Root;
 
-		return &m_Root->kv.second;
-	}
+		while(currentNode)
+		{
+			if(key < currentNode->kv.first)
+				currentNode = currentNode->left;
 
-	// insert
+			else if(key > currentNode->kv.first)
+				currentNode = currentNode->right;
 
-	Value* insert(const KeyValue& kv)
-	{
-		if(empty())
-		{
-			m_Root = new Node{kv};
-			return &m_Root->kv.second;
+			else
+				return &currentNode->kv.second;
 		}
 
-		m_Root = splay(kv.first, m_Root);
+		return nullptr;
+	}
 
-		if(kv.first < m_Root->kv.first)
-		{
-			Node* insertionNode = new Node{kv, m_Root->left, m_Root};
-			m_Root->left = nullptr;
-			m_Root = insertionNode;
-			return &m_Root->kv.second;
-		}
+	// insert
 
-		else if(kv.first > m_Root->kv.first)
-		{
-			Node* insertionNode = new Node{kv, m_Root, m_Root->right};
-			m_Root->right = nullptr;
-			m_Root = insertionNode;
-			return &m_Root->kv.second;
-		}
+	Value* insert(const KeyValue& kv)
+	{ return InsertImpl(kv); }
 
-		else return nullptr;
-	}
+	Value* insert(KeyValue&& kv)
+	{ return InsertImpl(std::move(kv)); }
 
 	// remove
 
@@ -130,10 +144,40 @@ public:
 			m_Root->right = removalNode->right;
 		}
 
-		delete removalNode;
+		m_Allocator.destroy(removalNode);
 		return true;
 	}
 
+	// balance
+
+	void balance()
+	{
+		// relinks the nodes into a tree of minimal height, for a tree only searched through the const search()
+		// from then on. nodes inserted in order leave a splay tree as a chain, which that search walks whole.
+
+		Array<Node*> nodes;
+		Array<Node*> stack;
+		Node* currentNode = m_Root;
+
+		// in-order walk with an explicit stack, the tree may be a long chain
+
+		while(currentNode || !stack.empty())
+		{
+			while(currentNode)
+			{
+				stack.InsertBack(currentNode);
+				currentNode = currentNode->left;
+			}
+
+			currentNode = stack.back();
+			stack.RemoveBack();
+			nodes.InsertBack(currentNode);
+			currentNode = currentNode->right;
+		}
+
+		m_Root = BalanceImpl(nodes, 0, nodes.size() - 1);
+	}
+
 	// print
 
 	void PrintPreOrder() const
@@ -147,13 +191,61 @@ public:
 
 private:
 
+	// insert implementation
+
+	template<typename KeyValueType>
+	Value* InsertImpl(KeyValueType&& kv)
+	{
+		// the key-value pair is moved into its node when passed as an rvalue
+
+		if(empty())
+		{
+			m_Root = m_Allocator.create(std::forward<KeyValueType>(kv));
+			return &m_Root->kv.second;
+		}
+
+		m_Root = splay(kv.first, m_Root);
+
+		if(kv.first < m_Root->kv.first)
+		{
+			Node* insertionNode = m_Allocator.create(std::forward<KeyValueType>(kv), m_Root->left, m_Root);
+			m_Root->left = nullptr;
+			m_Root = insertionNode;
+			return &m_Root->kv.second;
+		}
+
+		else if(kv.first > m_Root->kv.first)
+		{
+			Node* insertionNode = m_Allocator.create(std::forward<KeyValueType>(kv), m_Root, m_Root->right);
+			m_Root->right = nullptr;
+			m_Root = insertionNode;
+			return &m_Root->kv.second;
+		}
+
+		else return nullptr;
+	}
+
+	// balance implementation
+
+	static Node* BalanceImpl(const Array<Node*>& nodes, int first, int last)
+	{
+		if(first > last)
+			return nullptr;
+
+		int middle = first + (last - first) / 2;
+		Node* root = nodes[middle];
+		root->left = BalanceImpl(nodes, first, middle - 1);
+		root->right = BalanceImpl(nodes, middle + 1, last);
+		return root;
+	}
+
 	// copy implementation
 
 	void CopyImpl(Node*& thisNode, Node* otherNode)
 	{
 		if(otherNode)
 		{
-			thisNode = new Node{otherNode->kv};
+			thisNode = m_Allocator.create(otherNode->kv);
 			CopyImpl(thisNode->left, otherNode->left);
 			CopyImpl(thisNode->right, otherNode->right);
 		}
@@ -167,7 +259,12 @@ private:
 		{
 			ClearImpl(currentNode->left);
 			ClearImpl(currentNode->right);
-			delete currentNode;
+
+			if(Allocator<Node>::bulkClear)
+				currentNode->~Node();
+			else
+				m_Allocator.destroy(currentNode);
+
 			currentNode = nullptr;
 		}
 	}
@@ -206,7 +303,7 @@ private:
 
 	// rotation implementation
 
-	Node* RotateRight(Node* root) const
+	Node* RotateRight(Node* root)
 	{
 		Node* left = root->left;
 		root->left = left->right;
@@ -214,7 +311,7 @@ private:
 		return left;
 	}
 
-	Node* RotateLeft(Node* root) const
+	Node* RotateLeft(Node* root)
 	{
 		Node* right = root->right;
 		root->right = right->left;
@@ -224,7 +321,7 @@ private:
 
 	// splay implementation
 
-	Node* splay(const Key& searchedKey, Node* centerTree) const
+	Node* splay(const Key& searchedKey, Node* centerTree)
 	{
 		if(!centerTree)
 			return nullptr;
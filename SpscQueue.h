@@ -0,0 +1,79 @@
+#pragma once
+#include "util.h"
+#include "Array.h"
+#include <atomic>
+
+template<typename Type>
+class SpscQueue
+{
+	// bounded lock-free queue between exactly one producer thread and one consumer thread.
+	// slots form a power-of-two ring, the head and tail counters only grow and each is written by one side only.
+
+private:
+
+	// members
+
+	Array<Type> m_Slots;
+	unsigned long long m_Mask = 0;
+
+	char m_HeadPadding[64]{}; // keeps the counters on separate cache lines
+	std::atomic<unsigned long long> m_Head{0}; // next slot to pop, written by the consumer
+	char m_TailPadding[64]{};
+	std::atomic<unsigned long long> m_Tail{0}; // next slot to push, written by the producer
+
+public:
+
+	// constructors
+
+	explicit SpscQueue(int capacity)
+	{
+		int size = 1;
+
+		while(size < capacity)
+			size *= 2;
+
+		m_Slots.resize(size);
+		m_Mask = (unsigned long long)(size - 1);
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// access
+
+	int capacity() const
+	{ return m_Slots.size(); }
+
+	bool empty() const
+	{ return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire); }
+
+	// producer
+
+	bool push(Type&& data)
+	{
+		// data is only moved from when there is room
+
+		unsigned long long tail = m_Tail.load(std::memory_order_relaxed);
+
+		if(tail - m_Head.load(std::memory_order_acquire) == (unsigned long long)m_Slots.size())
+			return false;
+
+		m_Slots[int(tail & m_Mask)] = std::move(data);
+		m_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer
+
+	bool pop(Type& data)
+	{
+		unsigned long long head = m_Head.load(std::memory_order_relaxed);
+
+		if(head == m_Tail.load(std::memory_order_acquire))
+			return false;
+
+		data = std::move(m_Slots[int(head & m_Mask)]);
+		m_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+};
@@ -3,14 +3,14 @@
 #include "util.h"
 #include "List.h"
 
-template<typename Type>
+template<typename Type, template<typename> class Allocator = HeapAllocator>
 class Stack
 {
 private:
 
 	// members
 
-	List<Type> m_List;
+	List<Type, Allocator> m_List;
 
 public:
 
@@ -44,6 +44,9 @@ public:
 	void push(const Type& data)
 	{ m_List.InsertBack(data); }
 
+	void push(Type&& data)
+	{ m_List.InsertBack(std::move(data)); }
+
 	void pop()
 	{
 		ErrorAbort(empty(), "Stack::pop() : stack is empty");
@@ -52,9 +55,9 @@ public:
 
 	// compare
 
-	friend bool operator==(const Stack<Type>& s1, const Stack<Type>& s2)
+	friend bool operator==(const Stack& s1, const Stack& s2)
 	{ return s1.m_List == s2.m_List; }
 
-	friend bool operator!=(const Stack<Type>& s1, const Stack<Type>& s2)
+	friend bool operator!=(const Stack& s1, const Stack& s2)
 	{ return !(s1 == s2); }
 };
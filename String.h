@@ -2,14 +2,27 @@
 #pragma once
 #include "util.h"
 #include "Array.h"
+#include <cstring>
 
 class String
 {
+	// short strings, such as device addresses, are stored inline without a heap allocation.
+	// longer strings live on the heap, whose capacity doubles as characters are appended.
+
+public:
+
+	// constants
+
+	static constexpr int inlineCapacity = 15;
+
 private:
 
 	// members
 
-	Array<char> m_Data = Array<char>(1);
+	char* m_Data = m_Inline; // points at m_Inline or at a heap block, always null-terminated
+	int m_Size = 0;
+	int m_Capacity = inlineCapacity; // characters that fit before the terminator
+	char m_Inline[inlineCapacity + 1] = {};
 
 public:
 
@@ -18,16 +31,78 @@ public:
 	String() = default;
 
 	explicit String(int size)
-		: m_Data(Array<char>(size + 1))
-	{}
+	{
+		reserve(size);
+		FillChars(m_Data, size, '\0');
+		m_Size = size;
+	}
 
 	explicit String(char ch, int size)
-		: m_Data(Array<char>(size + 1, ch))
-	{ m_Data.back() = '\0'; }
+	{
+		reserve(size);
+		FillChars(m_Data, size, ch);
+		m_Size = size;
+		m_Data[m_Size] = '\0';
+	}
 
 	String(const char* str)
-		: m_Data(Array<char>(StrLen(str) + 1))
-	{ CopyArray(data(), str, size()); }
+	{ append(str, StrLen(str)); }
+
+	// memory management
+
+	String(const String& other)
+	{ append(other.data(), other.size()); }
+
+	String(String&& other) noexcept
+	{ *this = std::move(other); }
+
+	String& operator=(const String& other)
+	{
+		if(this != &other)
+		{
+			m_Size = 0;
+			append(other.data(), other.size());
+		}
+
+		return *this;
+	}
+
+	String& operator=(String&& other) noexcept
+	{
+		// heap blocks are taken over, inline strings are copied since they fit in any string
+
+		if(this != &other)
+		{
+			if(other.m_Data == other.m_Inline)
+			{
+				std::memcpy(m_Data, other.m_Data, other.m_Size + 1);
+				m_Size = other.m_Size;
+			}
+			else
+			{
+				if(m_Data != m_Inline)
+					delete[] m_Data;
+
+				m_Data = other.m_Data;
+				m_Size = other.m_Size;
+				m_Capacity = other.m_Capacity;
+
+				other.m_Data = other.m_Inline;
+				other.m_Capacity = inlineCapacity;
+			}
+
+			other.m_Size = 0;
+			other.m_Data[0] = '\0';
+		}
+
+		return *this;
+	}
+
+	~String()
+	{
+		if(m_Data != m_Inline)
+			delete[] m_Data;
+	}
 
 	// empty state
 
@@ -35,56 +110,83 @@ public:
 	{ return size() == 0; }
 
 	void clear()
-	{ m_Data = Array<char>(1); }
+	{
+		// keeps capacity, so a cleared string refills without allocating
+
+		m_Size = 0;
+		m_Data[0] = '\0';
+	}
+
+	// capacity
+
+	int capacity() const
+	{ return m_Capacity; }
+
+	void reserve(int capacity)
+	{
+		// new blocks are not zero-filled, only the used characters and terminator are copied
+
+		if(capacity <= m_Capacity)
+			return;
+
+		char* newData = new char[capacity + 1];
+		std::memcpy(newData, m_Data, m_Size + 1);
+
+		if(m_Data != m_Inline)
+			delete[] m_Data;
+
+		m_Data = newData;
+		m_Capacity = capacity;
+	}
 
 	// access
 
 	char* data()
-	{ return m_Data.data(); }
+	{ return m_Data; }
 
 	const char* data() const
-	{ return m_Data.data(); }
+	{ return m_Data; }
 
 	int size() const
-	{ return m_Data.size() - 1; }
+	{ return m_Size; }
 
 	int length() const
 	{ return size(); }
 
 	char& operator[](int index)
 	{
-		ErrorAbort(!InRange(index, 0, size() - 1), "String::operator[]() : index out of bounds");
-		return m_Data.data()[index];
+		CheckAccess(!InRange(index, 0, size() - 1), "String::operator[]() : index out of bounds");
+		return m_Data[index];
 	}
 
 	char operator[](int index) const
 	{
-		ErrorAbort(!InRange(index, 0, size() - 1), "String::operator[]() : index out of bounds");
-		return m_Data.data()[index];
+		CheckAccess(!InRange(index, 0, size() - 1), "String::operator[]() : index out of bounds");
+		return m_Data[index];
 	}
 
 	char& front()
 	{
 		ErrorAbort(empty(), "String::front() : string is empty");
-		return m_Data.data()[0];
+		return m_Data[0];
 	}
 
 	char front() const
 	{
 		ErrorAbort(empty(), "String::front() : string is empty");
-		return m_Data.data()[0];
+		return m_Data[0];
 	}
 
 	char& back()
 	{
 		ErrorAbort(empty(), "String::back() : string is empty");
-		return m_Data.data()[size() - 1];
+		return m_Data[size() - 1];
 	}
 
 	char back() const
 	{
 		ErrorAbort(empty(), "String::back() : string is empty");
-		return m_Data.data()[size() - 1];
+		return m_Data[size() - 1];
 	}
 
 	// insert
@@ -92,21 +194,48 @@ public:
 	void insert(char ch, int index)
 	{
 		ErrorAbort(!InRange(index, 0, size()), "String::insert() : index out of bounds");
-		m_Data.insert(ch, index);
+		grow(m_Size + 1);
+		std::memmove(m_Data + index + 1, m_Data + index, (m_Size - index) + 1);
+		m_Data[index] = ch;
+		m_Size++;
 	}
 
 	void InsertFront(char ch)
 	{ insert(ch, 0); }
 
 	void InsertBack(char ch)
-	{ insert(ch, size()); }
+	{
+		grow(m_Size + 1);
+		m_Data[m_Size++] = ch;
+		m_Data[m_Size] = '\0';
+	}
+
+	void append(const char* str, int count)
+	{
+		// str may point into this string, which growing moves
+
+		if(str >= m_Data && str < m_Data + m_Size)
+		{
+			int offset = int(str - m_Data);
+			grow(m_Size + count);
+			str = m_Data + offset;
+		}
+
+		else
+			grow(m_Size + count);
+
+		std::memmove(m_Data + m_Size, str, count);
+		m_Size += count;
+		m_Data[m_Size] = '\0';
+	}
 
 	// remove
 
 	void remove(int index)
 	{
 		ErrorAbort(!InRange(index, 0, size() - 1), "String::remove() : index out of bounds");
-		m_Data.remove(index);
+		std::memmove(m_Data + index, m_Data + index + 1, m_Size - index);
+		m_Size--;
 	}
 
 	void RemoveFront()
@@ -123,16 +252,16 @@ public:
 	// compare
 
 	friend bool operator==(const String& s1, const String& s2)
-	{ return s1.m_Data == s2.m_Data; }
+	{ return s1.size() == s2.size() && std::memcmp(s1.data(), s2.data(), s1.size()) == 0; }
 
 	friend bool operator!=(const String& s1, const String& s2)
 	{ return !(s1 == s2); }
 
 	friend bool operator<(const String& s1, const String& s2)
-	{ return s1.m_Data < s2.m_Data; }
+	{ return CompareArray(s1.data(), s2.data(), s1.size(), s2.size()) == -1; }
 
 	friend bool operator<=(const String& s1, const String& s2)
-	{ return s1.m_Data <= s2.m_Data; }
+	{ return CompareArray(s1.data(), s2.data(), s1.size(), s2.size()) != 1; }
 
 	friend bool operator>(const String& s1, const String& s2)
 	{ return s2 < s1; }
@@ -142,7 +271,17 @@ public:
 
 	// concatenate
 
-	String& operator+=(const String&);
+	String& operator+=(const String& other)
+	{
+		append(other.data(), other.size());
+		return *this;
+	}
+
+	String& operator+=(char ch)
+	{
+		InsertBack(ch);
+		return *this;
+	}
 
 	// sub-string
 
@@ -152,8 +291,8 @@ public:
 			end = size() - 1;
 
 		ErrorAbort(!(InRange(start, 0, size() - 1) && InRange(end, 0, size() - 1) && (start <= end)), "String::substr() : invalid index");
-		String result((end - start) + 1);
-		CopyArray(result.data(), data() + start, result.size());
+		String result;
+		result.append(data() + start, (end - start) + 1);
 		return result;
 	}
 
@@ -203,20 +342,61 @@ public:
 
 		return tokenArray;
 	}
+
+private:
+
+	// growth implementation
+
+	void grow(int size)
+	{
+		if(size > m_Capacity)
+			reserve(Max(size, m_Capacity * 2));
+	}
+
+	static void FillChars(char* str, int size, char ch)
+	{
+		std::memset(str, ch, size);
+		str[size] = '\0';
+	}
 };
 
 // concatenate
 
 String operator+(const String& s1, const String& s2)
 {
-	String result(s1.size() + s2.size());
-	CopyArray(result.data(), s1.data(), s1.size());
-	CopyArray(result.data() + s1.size(), s2.data(), s2.size());
+	String result;
+	result.reserve(s1.size() + s2.size());
+	result += s1;
+	result += s2;
 	return result;
 }
 
-String& String::operator+=(const String& other)
-{ return *this = *this + other; }
+// conversion
+
+String NumToStr(long long num)
+{
+	char digits[24];
+	int count = 0;
+	unsigned long long value = (num < 0) ? 0ull - (unsigned long long)num : (unsigned long long)num;
+
+	do
+	{
+		digits[count++] = char('0' + (value % 10));
+		value /= 10;
+
+	} while(value);
+
+	String result;
+	result.reserve(count + 1);
+
+	if(num < 0)
+		result += '-';
+
+	while(count)
+		result += digits[--count];
+
+	return result;
+}
 
 // input
 
@@ -0,0 +1,119 @@
+#pragma once
+#include "util.h"
+#include "Array.h"
+#include <functional>
+#include <condition_variable>
+#include <atomic>
+
+class ThreadPool
+{
+private:
+
+	// members
+
+	Array<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_WakeCondition;
+	std::condition_variable m_DoneCondition;
+
+	const std::function<void(int)>* m_Job = nullptr;
+	std::atomic<int> m_NextJob{0};
+	int m_JobCount = 0;
+	int m_ActiveWorkers = 0;
+	long long m_Generation = 0;
+	bool m_Stop = false;
+
+public:
+
+	// constructors and memory management
+
+	explicit ThreadPool(int workerCount = DefaultWorkerCount())
+		: m_Workers(Max(workerCount, 0))
+	{
+		for(int index = 0; index < m_Workers.size(); index++)
+			m_Workers[index] = std::thread(&ThreadPool::WorkerLoop, this);
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_Mutex);
+			m_Stop = true;
+		}
+
+		m_WakeCondition.notify_all();
+
+		for(int index = 0; index < m_Workers.size(); index++)
+			m_Workers[index].join();
+	}
+
+	// access
+
+	int WorkerCount() const
+	{ return m_Workers.size(); }
+
+	static int DefaultWorkerCount()
+	{ return int(std::thread::hardware_concurrency()) - 1; } // calling thread works too
+
+	// run
+
+	void ParallelFor(int jobCount, const std::function<void(int)>& job)
+	{
+		// runs job(0) ... job(jobCount - 1) across the workers and the calling thread, returns when all are done.
+
+		if(jobCount <= 0)
+			return;
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Job = &job;
+		m_JobCount = jobCount;
+		m_NextJob = 0;
+		m_ActiveWorkers = m_Workers.size();
+		m_Generation++;
+		lock.unlock();
+
+		m_WakeCondition.notify_all();
+		RunJobs();
+
+		lock.lock();
+		m_DoneCondition.wait(lock, [this]() { return m_ActiveWorkers == 0; });
+		m_Job = nullptr;
+	}
+
+private:
+
+	// worker implementation
+
+	void RunJobs()
+	{
+		for(int index = m_NextJob++; index < m_JobCount; index = m_NextJob++)
+			(*m_Job)(index);
+	}
+
+	void WorkerLoop()
+	{
+		long long generation = 0;
+
+		while(true)
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WakeCondition.wait(lock, [&]() { return m_Stop || m_Generation != generation; });
+
+			if(m_Stop)
+				return;
+
+			generation = m_Generation;
+			lock.unlock();
+
+			RunJobs();
+
+			lock.lock();
+
+			if(--m_ActiveWorkers == 0)
+				m_DoneCondition.notify_one();
+		}
+	}
+};
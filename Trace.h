@@ -0,0 +1,73 @@
+#pragma once
+#include "util.h"
+#include "Array.h"
+
+class Trace
+{
+	// route of a message as the ids of the devices it reached, with the virtual time of each arrival.
+	// the first hops are stored inline in the message, longer routes spill the rest into an array.
+
+public:
+
+	// types
+
+	struct Hop
+	{
+		int deviceID = -1;
+		double time = 0.0;
+	};
+
+	// constants
+
+	static constexpr int inlineCapacity = 8;
+
+private:
+
+	// members
+
+	Hop m_Inline[inlineCapacity];
+	Array<Hop> m_Overflow; // hops past the inline ones
+	int m_Size = 0;
+
+public:
+
+	// empty state
+
+	bool empty() const
+	{ return m_Size == 0; }
+
+	void clear()
+	{
+		m_Overflow.clear();
+		m_Size = 0;
+	}
+
+	// access
+
+	int size() const
+	{ return m_Size; }
+
+	const Hop& operator[](int index) const
+	{
+		ErrorAbort(!InRange(index, 0, m_Size - 1), "Trace::operator[]() : index out of bounds");
+		return (index < inlineCapacity) ? m_Inline[index] : m_Overflow[index - inlineCapacity];
+	}
+
+	const Hop& front() const
+	{ return (*this)[0]; }
+
+	const Hop& back() const
+	{ return (*this)[m_Size - 1]; }
+
+	// insert
+
+	void InsertBack(int deviceID, double time)
+	{
+		if(m_Size < inlineCapacity)
+			m_Inline[m_Size] = {deviceID, time};
+		else
+			m_Overflow.InsertBack({deviceID, time});
+
+		m_Size++;
+	}
+};
@@ -3,58 +3,72 @@
 #include "util.h"
 #include "Network.h"
 #include "CommandParser.h"
+#include "CsvReader.h"
+
+// topology files, a snapshot is named in lowercase like every file given in a command
+
+const char* const topologyFile = "Network.csv";
+const char* const snapshotFile = "network.snap";
+
+// delivered paths, indexed beside the log in <log>.idx. the binary log is several times smaller,
+// export path writes its text form.
+
+#ifndef BINARY_PATH_LOG
+#define BINARY_PATH_LOG 0
+#endif
+
+#if BINARY_PATH_LOG
+const char* const pathFile = "path.bin";
+#else
+const char* const pathFile = "path.txt";
+#endif
 
 // ======================================================================================================================================================
 // Send Message
 // ======================================================================================================================================================
 
-Message CreateMessage(const String& msgStr)
+bool ParseMessage(const String& msgStr, Message& msg)
 {
 	auto tokens = msgStr.split(':');
 
 	if(!(tokens.size() == 5 && CommandParser::IsMachineAddress(tokens[2]) && CommandParser::IsMachineAddress(tokens[3])))
-	{
+		return false;
+
+	msg = {StrToInt(tokens[0].data()), StrToInt(tokens[1].data()), tokens[2], tokens[3], tokens[4]};
+	return true;
+}
+
+Message CreateMessage(const String& msgStr)
+{
+	Message msg;
+
+	if(!ParseMessage(msgStr, msg))
 		std::cout << "\nFile parsing error, messages could not be sent.\n";
-		return {};
-	}
 
-	return {StrToInt(tokens[0].data()), StrToInt(tokens[1].data()), tokens[2], tokens[3], tokens[4]};
+	return msg;
 }
 
 List<Message> ParseMessageFile(const String& filepath)
 {
-	std::ifstream fin(filepath.data());
+	CsvReader reader(filepath);
 
-	if(!fin)
+	if(!reader.IsOpen())
 	{
 		std::cout << "\nFile opening error, messages could not be sent.\n";
 		return {};
 	}
 
 	List<Message> msgList;
-	String line;
+	Token line;
 
-	while(true)
-	{
-		char ch = fin.get();
-
-		if(ch == '\n' || !fin)
-		{
-			msgList.InsertBack(CreateMessage(line));
-			line.clear();
-
-			if(!fin)
-				break;
-		}
-
-		else
-			line.InsertBack(ch);
-	}
+	while(reader.ReadLine(line))
+		if(!line.empty())
+			msgList.InsertBack(CreateMessage(line.str()));
 
 	return msgList;
 }
 
-void ExecuteSendMsg(const String& filepath)
+void ExecuteSendMsg(const String& filepath, bool display)
 {
 	auto msgList = ParseMessageFile(filepath);
 
@@ -70,7 +84,77 @@ void ExecuteSendMsg(const String& filepath)
 		std::cout << "\n[" << msg->ID << ", " << msg->priority << ", " << msg->srcAddress << ", " << msg->dstAddress << ", " << msg->payload << "]";
 
 	std::cout << "\n";
-	Network::SendMsg(msgList, "path.txt");
+	Network::SendMsg(std::move(msgList), pathFile, display);
+}
+
+void ExecuteStreamMsg(const String& filepath, bool display)
+{
+	// messages are read in batches while they are forwarded, standard input is read until an empty line and each
+	// message typed in is forwarded as soon as it is entered. malformed lines are reported and skipped, the stream goes on.
+
+	if(filepath == "-")
+	{
+		std::cout << "\nEnter messages, one per line, then an empty line to stop\n";
+
+		auto source = [](Message& msg)
+		{
+			const int maxInputSize = 1024;
+			char line[maxInputSize]{};
+
+			while(true)
+			{
+				if(!std::cin.getline(line, maxInputSize))
+				{
+					std::cin.clear();
+					return false;
+				}
+
+				int size = StrLen(line);
+
+				if(size > 0 && line[size - 1] == '\r')
+					line[--size] = '\0';
+
+				if(size == 0)
+					return false;
+
+				if(ParseMessage(line, msg))
+					return true;
+
+				std::cout << "\nSkipped malformed message \"" << line << "\"\n";
+			}
+		};
+
+		Network::StreamMsg(source, pathFile, display, false);
+		return;
+	}
+
+	auto reader = std::make_shared<CsvReader>(filepath);
+
+	if(!reader->IsOpen())
+	{
+		std::cout << "\nFile opening error, messages could not be sent.\n";
+		return;
+	}
+
+	auto source = [reader](Message& msg)
+	{
+		Token line;
+
+		while(reader->ReadLine(line))
+		{
+			if(!line.empty())
+			{
+				if(ParseMessage(line.str(), msg))
+					return true;
+
+				std::cout << "\nSkipped malformed message \"" << line.str() << "\"\n";
+			}
+		}
+
+		return false;
+	};
+
+	Network::StreamMsg(source, pathFile, display);
 }
 
 // ======================================================================================================================================================
@@ -79,41 +163,33 @@ void ExecuteSendMsg(const String& filepath)
 
 Network::Router::List Parse_RT_File(const String& filepath)
 {
-	std::ifstream fin(filepath.data());
+	CsvReader reader(filepath);
 
-	if(!fin)
+	if(!reader.IsOpen())
 	{
 		std::cout << "\nFile opening error, routing table could not be changed.\n";
 		return {};
 	}
 
 	Network::Router::List fieldList;
-	String line;
+	Token line;
+	Array<Token> tokens;
 
-	while(true)
+	while(reader.ReadLine(line))
 	{
-		char ch = fin.get();
-
-		if(ch == '\n' || !fin)
-		{
-			auto tokens = line.split(':');
-			bool valid = (tokens.size() == 2) && (CommandParser::IsMachineAddress(tokens[0])) && (CommandParser::IsDeviceAddress(tokens[1]));
-
-			if(!valid)
-			{
-				std::cout << "\nFile parsing error, routing table could not be changed.\n";
-				return {};
-			}
+		if(line.empty())
+			continue;
 
-			fieldList.InsertBack({tokens[0], tokens[1]});
-			line.clear();
+		line.split(':', tokens);
+		bool valid = (tokens.size() == 2) && (CommandParser::IsMachineAddress(tokens[0].str())) && (CommandParser::IsDeviceAddress(tokens[1].str()));
 
-			if(!fin)
-				break;
+		if(!valid)
+		{
+			std::cout << "\nFile parsing error, routing table could not be changed.\n";
+			return {};
 		}
 
-		else
-			line.InsertBack(ch);
+		fieldList.InsertBack({tokens[0].str(), tokens[1].str()});
 	}
 
 	return fieldList;
@@ -146,7 +222,7 @@ void ExecuteChangeRT(const String& routerAddress, const String& action, const St
 // ======================================================================================================================================================
 
 void ExecutePrintPath(const String& srcAddress, const String& dstAddress)
-{ Network::PrintPath(srcAddress.upper(), dstAddress.upper(), "path.txt"); }
+{ Network::PrintPath(srcAddress.upper(), dstAddress.upper(), pathFile); }
 
 // ======================================================================================================================================================
 // Change Edge
@@ -183,69 +259,61 @@ List<Network::Graph::Edge> ParseChangeEdgeFile(const String& filepath)
 
 	// open file
 
-	std::ifstream fin(filepath.data());
+	CsvReader reader(filepath);
 
-	if(!fin)
+	if(!reader.IsOpen())
 		return openingError();
 
-	// parse file
+	// parse file, the header row of device names is skipped
 
 	List<Network::Graph::Edge> edgeList;
-	char ch = '\0';
-	String token;
+	Token line;
+	Array<Token> cells;
 	int rowIndex = -1;
-	int colIndex = -1;
 
-	while(true)
+	while(reader.ReadLine(line))
 	{
-		// indices should always be in range
+		if(line.empty())
+			continue;
 
-		if(!(InRange(rowIndex, -1, Network::DeviceCount()) && InRange(colIndex, -1, Network::DeviceCount())))
-			return parsingError();
+		if(rowIndex == -1)
+		{
+			rowIndex = 0;
+			continue;
+		}
 
-		ch = fin.get();
+		line.split(',', cells);
 
-		if(!fin || ch == '\n' || ch == ',')
+		for(int colIndex = 0; colIndex < cells.size() - 1; colIndex++)
 		{
-			if(rowIndex == -1 && token.size() > 1)
-			{}
+			const Token& cell = cells[colIndex + 1];
+			double weight = 0.0;
 
-			else if(colIndex != -1 && !token.empty() && token.front() != '?')
-			{
-				// edge weights should be numbers
-
-				if(!StrIsNum(token.data()))
-					return parsingError();
+			if(cell.empty() || cell.front() == '?')
+				continue;
 
-				// if edge is not already present, then change.
+			// indices should always be in range, edge weights should be numbers
 
-				auto edge1Iter = Network::GetEdge(rowIndex, colIndex);
+			if(!(InRange(rowIndex, 0, Network::DeviceCount() - 1) && InRange(colIndex, 0, Network::DeviceCount() - 1)))
+				return parsingError();
 
-				if(!edge1Iter.valid())
-					return parsingError();
+			if(!cell.ToReal(weight))
+				return parsingError();
 
-				Network::Graph::Edge edge2 = {rowIndex, colIndex, double(int(token.front())) - '0'};
+			// if edge is not already present, then change.
 
-				if(!compareEdges(*edge1Iter, edge2))
-					edgeList.InsertBack(edge2);
-			}
+			auto edge1Iter = Network::GetEdge(rowIndex, colIndex);
 
-			token.clear();
+			if(!edge1Iter.valid())
+				return parsingError();
 
-			if(ch == ',')
-				colIndex++;
+			Network::Graph::Edge edge2 = {rowIndex, colIndex, weight};
 
-			else if(ch == '\n')
-			{
-				rowIndex++;
-				colIndex = -1;
-			}
-
-			else if(!fin)
-				break;
+			if(!compareEdges(*edge1Iter, edge2))
+				edgeList.InsertBack(edge2);
 		}
-		else
-			token.InsertBack(ch);
+
+		rowIndex++;
 	}
 
 	// returns list of edges not already present in the network
@@ -292,6 +360,56 @@ void ExecuteChangeEdge(const String& filepath)
 		std::cout << "\nFailed to change edge, could not update routing tables.\n";
 }
 
+// ======================================================================================================================================================
+// Remove Device
+// ======================================================================================================================================================
+
+void ExecuteRemoveDevice(const String& deviceAddress)
+{
+	Network::PrintGraph();
+	Network::PrintRoutingTables();
+
+	if(Network::RemoveDevice(deviceAddress.upper()))
+	{
+		std::cout << "\nRemoved device successfully, routing tables updated.\n";
+		EnterToContinue("\nPress enter to see changes...");
+		Network::PrintGraph();
+		Network::PrintRoutingTables();
+	}
+	else
+		std::cout << "\nFailed to remove device, it is unknown, a router with machines, or messages are in flight.\n";
+}
+
+// ======================================================================================================================================================
+// Save Snapshot
+// ======================================================================================================================================================
+
+void ExecuteSaveSnapshot(const String& filepath)
+{
+	// a snapshot holds devices by consecutive ids, so removed devices are compacted away first
+
+	Network::CompactDevices();
+
+	if(Network::SaveSnapshot(filepath))
+		std::cout << "\nSnapshot saved to " << filepath << ", it is loaded instead of " << topologyFile << " when named " << snapshotFile << " while " << topologyFile << " is unchanged.\n";
+	else
+		std::cout << "\nFailed to save snapshot to " << filepath << "\n";
+}
+
+// ======================================================================================================================================================
+// Export Path
+// ======================================================================================================================================================
+
+void ExecuteExportPath(const String& filepath)
+{
+	long long count = Network::ExportPath(pathFile, filepath);
+
+	if(count >= 0)
+		std::cout << "\nExported " << count << " paths from " << pathFile << " to " << filepath << "\n";
+	else
+		std::cout << "\nFailed to export paths to " << filepath << "\n";
+}
+
 // ======================================================================================================================================================
 // User Interface
 // ======================================================================================================================================================
@@ -302,8 +420,12 @@ int SolveQuery(const String& query)
 	Network::PrintGraph();
 	Network::PrintMap();
 	Network::PrintMachineRouters();
+	Network::PrintNetAddresses();
 	Network::PrintRoutingLists();
 	Network::PrintRoutingTrees();
+	Network::PrintRoutingHashes();
+	Network::PrintRoutingDirects();
+	Network::PrintRoutingTries();
 	#endif
 
 	if(simulation::thread)
@@ -339,8 +461,14 @@ int SolveQuery(const String& query)
 
 	else if(parser.IsSendMsg())
 	{
-		// send msg <filename>
-		ExecuteSendMsg(parser.GetToken(2));
+		// send msg <filename> [display]
+		ExecuteSendMsg(parser.GetToken(2), parser.IsDisplayMode());
+	}
+
+	else if(parser.IsStreamMsg())
+	{
+		// stream msg <filename | -> [display]
+		ExecuteStreamMsg(parser.GetToken(2), parser.IsDisplayMode());
 	}
 
 	else if(parser.IsChangeRT())
@@ -365,7 +493,7 @@ int SolveQuery(const String& query)
 		src.RemoveBack();
 		dst.RemoveBack();
 
-		ExecuteChangeEdge(src, dst, StrToInt(parser.GetToken(4).data()));
+		ExecuteChangeEdge(src, dst, StrToReal(parser.GetToken(4).data()));
 	}
 
 	else if(parser.IsChangeEdgeFileInput())
@@ -374,6 +502,24 @@ int SolveQuery(const String& query)
 		ExecuteChangeEdge(parser.GetToken(2));
 	}
 
+	else if(parser.IsRemoveDevice() && !simulation::thread)
+	{
+		// remove device <device>
+		ExecuteRemoveDevice(parser.GetToken(2));
+	}
+
+	else if(parser.IsSaveSnapshot() && !simulation::thread)
+	{
+		// save snapshot <filename>
+		ExecuteSaveSnapshot(parser.GetToken(2));
+	}
+
+	else if(parser.IsExportPath() && !simulation::thread)
+	{
+		// export path <filename>
+		ExecuteExportPath(parser.GetToken(2));
+	}
+
 	else if(!simulation::thread)
 		std::cout << "\nCommand Not Found\n";
 
@@ -414,9 +560,26 @@ void MainMenu()
 	std::cout << "\nNetwork Simulator\n";
 	std::cout << "\n" << String('=', 100) << "\n";
 
+	// a saved snapshot skips parsing and shortest paths, unless the topology file changed after it was saved
+
+	String filepath = topologyFile;
+
+	if(Network::IsSnapshot(snapshotFile))
+	{
+		if(Network::IsSnapshotCurrent(snapshotFile, topologyFile))
+			filepath = snapshotFile;
+		else
+			std::cout << "\n" << snapshotFile << " is out of date with " << topologyFile << " and is ignored\n";
+	}
+
+	std::cout << "\nNetwork is read from " << filepath << "\n";
+
 	std::cout << "\nStructures for Routing Tables\n";
 	std::cout << "\n1. Linear Lists\n";
 	std::cout << "\n2. Splay Trees\n";
+	std::cout << "\n3. Hash Tables\n";
+	std::cout << "\n4. Direct Arrays\n";
+	std::cout << "\n5. Prefix Tries\n";
 
 	String inputPrompt = "\n---> Enter your choice: ";
 	String errorPrompt = "\n---> Invalid input. Enter again: ";
@@ -431,16 +594,23 @@ void MainMenu()
 		validChoice = true;
 		input(inputChoice, inputPrompt.data(), errorPrompt.data());
 
-		if(!InRange(inputChoice, 1, 2))
+		if(!InRange(inputChoice, 1, 5))
 			validChoice = false;
 
 	} while(!validChoice);
 
 	if(inputChoice == 1)
-		Network::Init("Network.csv", Network::Router::TableType::List);
+		Network::Init(filepath, Network::Router::TableType::List);
 	else if(inputChoice == 2)
-		Network::Init("Network.csv", Network::Router::TableType::Tree);
-
+		Network::Init(filepath, Network::Router::TableType::Tree);
+	else if(inputChoice == 3)
+		Network::Init(filepath, Network::Router::TableType::Hash);
+	else if(inputChoice == 4)
+		Network::Init(filepath, Network::Router::TableType::Direct);
+	else if(inputChoice == 5)
+		Network::Init(filepath, Network::Router::TableType::Trie);
+
+	Network::OpenPathLog(pathFile);
 	RunQueries();
 
 	std::cout << "\n" << String('=', 100) << "\n";
@@ -457,7 +627,7 @@ void RunCommandLine()
 
 	Network::Init("Network.csv", Network::Router::TableType::Tree);
 	// std::ofstream("path.txt");
-	// ExecuteSendMsg("message.txt");
+	// ExecuteSendMsg("message.txt", false);
 	// ExecuteChangeRT("R1", "add", "RT1.csv");
 	// ExecutePrintPath("m3", "m5");
 	// ExecuteChangeEdge("R1", "R2", 25);
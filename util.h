@@ -4,8 +4,21 @@
 #include <fstream>
 #include <thread>
 #include <mutex>
+#include <utility>
+#include <type_traits>
+#include <cstring>
 using namespace std::literals::chrono_literals;
 
+// bounds checks of element access, off in release builds unless asked for
+
+#ifndef CHECKED_ACCESS
+#ifdef NDEBUG
+#define CHECKED_ACCESS 0
+#else
+#define CHECKED_ACCESS 1
+#endif
+#endif
+
 // assert-exception
 
 void ErrorAbort(bool condition, const char* message)
@@ -17,6 +30,17 @@ void ErrorAbort(bool condition, const char* message)
 	}
 }
 
+void CheckAccess(bool condition, const char* message)
+{
+	// ErrorAbort() for element access, compiled out when CHECKED_ACCESS is 0
+
+	#if CHECKED_ACCESS
+
+	ErrorAbort(condition, message);
+
+	#endif
+}
+
 // numbers
 
 bool InRange(int num, int min, int max)
@@ -75,6 +99,154 @@ int StrToInt(const char* str)
 	return num;
 }
 
+bool StrIsReal(const char* str)
+{
+	// digits, optional fraction such as 12.75. unsigned like the edge weights it reads
+
+	int index = 0;
+	int digits = 0;
+	bool point = false;
+
+	for(; str[index]; index++)
+	{
+		if(IsDigit(str[index]))
+			digits++;
+
+		else if(str[index] == '.' && !point)
+			point = true;
+
+		else
+			return false;
+	}
+
+	return digits > 0;
+}
+
+double StrToReal(const char* str)
+{
+	ErrorAbort(!StrIsReal(str), "StrToReal() : string is not a real number");
+
+	int index = 0;
+	double num = 0.0;
+	double scale = 1.0;
+	bool point = false;
+
+	for(; str[index]; index++)
+	{
+		if(str[index] == '.')
+			point = true;
+
+		else
+		{
+			num = (num * 10.0) + (str[index] - '0');
+
+			if(point)
+				scale *= 10.0;
+		}
+	}
+
+	return num / scale;
+}
+
+bool StrIsNetAddress(const char* str)
+{
+	// dotted quad such as 10.0.1.2
+
+	int octets = 0;
+	int digits = 0;
+	int value = 0;
+
+	for(int index = 0; ; index++)
+	{
+		if(IsDigit(str[index]))
+		{
+			value = (value * 10) + (str[index] - '0');
+			digits++;
+
+			if(digits > 3 || value > 255)
+				return false;
+		}
+
+		else if(str[index] == '.' || str[index] == '\0')
+		{
+			if(digits == 0)
+				return false;
+
+			octets++;
+			digits = 0;
+			value = 0;
+
+			if(str[index] == '\0')
+				return octets == 4;
+
+			if(octets == 4)
+				return false;
+		}
+
+		else
+			return false;
+	}
+}
+
+unsigned StrToNetAddress(const char* str)
+{
+	ErrorAbort(!StrIsNetAddress(str), "StrToNetAddress() : string is not a network address");
+
+	unsigned address = 0;
+	unsigned octet = 0;
+
+	for(int index = 0; ; index++)
+	{
+		if(IsDigit(str[index]))
+			octet = (octet * 10) + (str[index] - '0');
+
+		else
+		{
+			address = (address << 8) | octet;
+			octet = 0;
+
+			if(str[index] == '\0')
+				return address;
+		}
+	}
+}
+
+// checksums
+
+unsigned Crc32(const char* data, int size)
+{
+	// crc-32 as used by zip and png, one table lookup per byte
+
+	struct Table
+	{
+		unsigned entries[256];
+	};
+
+	static const Table table = []()
+	{
+		Table result{};
+
+		for(unsigned index = 0; index < 256; index++)
+		{
+			unsigned crc = index;
+
+			for(int bit = 0; bit < 8; bit++)
+				crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : (crc >> 1);
+
+			result.entries[index] = crc;
+		}
+
+		return result;
+	}();
+
+	unsigned crc = 0xFFFFFFFFu;
+
+	for(int index = 0; index < size; index++)
+		crc = table.entries[(crc ^ (unsigned char)data[index]) & 0xFF] ^ (crc >> 8);
+
+	return crc ^ 0xFFFFFFFFu;
+}
+
 // templates
 
 template<typename NumType>
@@ -92,9 +264,9 @@ Type Max(const Type& a, const Type& b)
 template<typename Type>
 void Swap(Type& a, Type& b)
 {
-	Type t = a;
-	a = b;
-	b = t;
+	Type t = std::move(a);
+	a = std::move(b);
+	b = std::move(t);
 }
 
 template<typename FloatType>
@@ -103,13 +275,42 @@ bool FComp(FloatType a, FloatType b, FloatType epsilon)
 
 // arrays
 
+// trivially copyable elements are moved as bytes. the overload is chosen at compile time, so other types
+// never instantiate memmove.
+
 template<typename Type>
-void CopyArray(Type* dst, const Type* src, int size)
+void CopyArrayImpl(Type* dst, const Type* src, int size, std::true_type)
+{
+	if(size > 0)
+		std::memmove(dst, src, size * sizeof(Type));
+}
+
+template<typename Type>
+void CopyArrayImpl(Type* dst, const Type* src, int size, std::false_type)
 {
 	for(int index = 0; index < size; index++)
 		dst[index] = src[index];
 }
 
+template<typename Type>
+void MoveArrayImpl(Type* dst, Type* src, int size, std::true_type)
+{ CopyArrayImpl(dst, src, size, std::true_type()); }
+
+template<typename Type>
+void MoveArrayImpl(Type* dst, Type* src, int size, std::false_type)
+{
+	for(int index = 0; index < size; index++)
+		dst[index] = std::move(src[index]);
+}
+
+template<typename Type>
+void CopyArray(Type* dst, const Type* src, int size)
+{ CopyArrayImpl(dst, src, size, std::is_trivially_copyable<Type>()); }
+
+template<typename Type>
+void MoveArray(Type* dst, Type* src, int size)
+{ MoveArrayImpl(dst, src, size, std::is_trivially_copyable<Type>()); }
+
 template<typename Type>
 void FillArray(Type* array, int size, const Type& data)
 {
@@ -207,18 +408,30 @@ void SortArrayDescending(Type* array, int size)
 template<typename Type>
 void ShiftArrayLeft(Type* array, int size)
 {
-	for(int index = 0; index < size - 1; index++)
-		array[index] = array[index + 1];
+	if(size > 1)
+		MoveArrayImpl(array, array + 1, size - 1, std::is_trivially_copyable<Type>());
 
 	array[size - 1] = Type();
 }
 
 template<typename Type>
-void ShiftArrayRight(Type* array, int size)
+void ShiftArrayRightImpl(Type* array, int size, std::true_type)
+{
+	if(size > 1)
+		std::memmove(array + 1, array, (size - 1) * sizeof(Type));
+}
+
+template<typename Type>
+void ShiftArrayRightImpl(Type* array, int size, std::false_type)
 {
 	for(int index = size - 1; index > 0; index--)
-		array[index] = array[index - 1];
+		array[index] = std::move(array[index - 1]);
+}
 
+template<typename Type>
+void ShiftArrayRight(Type* array, int size)
+{
+	ShiftArrayRightImpl(array, size, std::is_trivially_copyable<Type>());
 	array[0] = Type();
 }
 
@@ -318,4 +531,14 @@ namespace simulation
 	std::mutex lock;
 	bool run_flag = false;
 	bool lock_flag = false;
+
+	// display mode paces events against the wall clock and logs every hop
+
+	bool display_flag = false;
+	std::chrono::milliseconds display_pace = 250ms; // per unit of virtual time
+	const int batch_size = 4096; // events processed per lock in fast mode
+
+	// streamed messages are only injected while fewer than this many are in flight
+
+	long long max_in_flight = 1 << 16;
 };